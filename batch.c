@@ -0,0 +1,265 @@
+#include "batch.h"
+#include "stats.h"
+
+// Line masks and weights prepared once per call
+typedef struct {
+    int num_lines;
+    uint64_t lo[MAX_LINES];
+    uint64_t hi[MAX_LINES];
+    int32_t weight[MAX_LINES][MAX_PLAYERS][MAX_PLAYERS * (MAX_SIZE + 1)];
+    uint64_t full_lo;
+    uint64_t full_hi;
+} BatchTables;
+
+// Slice of a batch handed to one thread
+typedef struct {
+    const BatchTables *tables;
+    PositionBatch *batch;
+    int begin;
+    int end;
+} BatchSlice;
+
+
+//Cache-line aligned array, rounded up to whole cache lines
+
+static void* aligned_array(size_t count, size_t elem) {
+    size_t bytes = (count * elem + 63) & ~(size_t)63;
+    void *data = aligned_alloc(64, bytes ? bytes : 64);
+    if (data) {
+        STATS_INC(allocations);
+    }
+    return data;
+}
+
+
+//Allocate a batch for up to capacity positions of one board
+
+PositionBatch* batch_create(int size, int num_players, int capacity) {
+    PositionBatch *batch = (PositionBatch*)calloc(1, sizeof(PositionBatch));
+    if (!batch) {
+        printf("Memory allocation failed!\n");
+        return NULL;
+    }
+
+    batch->size = size;
+    batch->num_players = num_players;
+    batch->capacity = capacity;
+
+    int ok = (batch->status = (unsigned char*)aligned_array(capacity, 1)) != NULL &&
+             (batch->winner = (signed char*)aligned_array(capacity, 1)) != NULL;
+    for (int p = 0; p < num_players && ok; p++) {
+        ok = (batch->lo[p] = (uint64_t*)aligned_array(capacity, sizeof(uint64_t))) != NULL &&
+             (batch->hi[p] = (uint64_t*)aligned_array(capacity, sizeof(uint64_t))) != NULL &&
+             (batch->score[p] = (int32_t*)aligned_array(capacity, sizeof(int32_t))) != NULL;
+    }
+
+    if (!ok) {
+        printf("Memory allocation failed!\n");
+        batch_destroy(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+
+//Release a batch and its arrays
+
+void batch_destroy(PositionBatch *batch) {
+    if (batch) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            free(batch->lo[p]);
+            free(batch->hi[p]);
+            free(batch->score[p]);
+        }
+        free(batch->status);
+        free(batch->winner);
+        free(batch);
+    }
+}
+
+
+//Empty the batch, keeping its memory
+
+void batch_clear(PositionBatch *batch) {
+    batch->count = 0;
+}
+
+
+//Append a position, returns 0 if the batch is full or for another board
+
+int batch_push(PositionBatch *batch, const Position *pos) {
+    if (batch->count == batch->capacity || pos->size != batch->size ||
+        pos->num_players != batch->num_players) {
+        return 0;
+    }
+
+    uint64_t lo[MAX_PLAYERS] = {0}, hi[MAX_PLAYERS] = {0};
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (pos->cells[cell]) {
+            int p = pos->cells[cell] - 1;
+            if (cell < 64) lo[p] |= 1ULL << cell;
+            else hi[p] |= 1ULL << (cell - 64);
+        }
+    }
+
+    int i = batch->count++;
+    for (int p = 0; p < batch->num_players; p++) {
+        batch->lo[p][i] = lo[p];
+        batch->hi[p][i] = hi[p];
+    }
+    return 1;
+}
+
+
+//Line masks and a weight table indexed [line][player][owner * (size + 1) + count]
+
+static void build_tables(const Engine *engine, int num_players, BatchTables *tables) {
+    int np = num_players;
+
+    memset(tables, 0, sizeof(BatchTables));
+    tables->num_lines = engine->num_lines;
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int k = 0; k < engine->size; k++) {
+            int cell = engine->line_cells[line][k];
+            if (cell < 64) tables->lo[line] |= 1ULL << cell;
+            else tables->hi[line] |= 1ULL << (cell - 64);
+        }
+        for (int q = 0; q < np; q++) {
+            for (int owner = 0; owner < np; owner++) {
+                for (int c = 0; c <= engine->size; c++) {
+                    tables->weight[line][q][owner * (engine->size + 1) + c] =
+                        engine->weights[line][(owner - q + np) % np][c];
+                }
+            }
+        }
+    }
+
+    for (int cell = 0; cell < engine->size * engine->size; cell++) {
+        if (cell < 64) tables->full_lo |= 1ULL << cell;
+        else tables->full_hi |= 1ULL << (cell - 64);
+    }
+}
+
+
+//Evaluate one block for a fixed player count (inlined once per count so the
+//loops over players unroll and the sweeps over positions are branch free): each
+//line is first reduced to a key, 0 for empty or blocked lines, else
+//owner * (size + 1) + count
+
+static inline __attribute__((always_inline))
+void evaluate_block(const BatchTables *tables, PositionBatch *batch, int start, int stop, int np) {
+    int size = batch->size;
+    int stride = size + 1;
+    unsigned char key[BATCH_BLOCK];
+    unsigned char won[BATCH_BLOCK];
+    int n = stop - start;
+
+    memset(won, 0, n);
+    for (int q = 0; q < np; q++) {
+        memset(&batch->score[q][start], 0, n * sizeof(int32_t));
+    }
+
+    for (int line = 0; line < tables->num_lines; line++) {
+        uint64_t mlo = tables->lo[line], mhi = tables->hi[line];
+
+        for (int i = 0; i < n; i++) {
+            int total = 0, owners = 0, base = 0;
+            for (int p = 0; p < np; p++) {
+                int c = __builtin_popcountll(batch->lo[p][start + i] & mlo) +
+                        __builtin_popcountll(batch->hi[p][start + i] & mhi);
+                total += c;
+                owners += c > 0;
+                base += c > 0 ? p * stride : 0;
+            }
+            int k = owners == 1 ? base + total : 0;
+            key[i] = (unsigned char)k;
+            won[i] = total == size && owners == 1 ? (unsigned char)(base / stride + 1) : won[i];
+        }
+
+        for (int q = 0; q < np; q++) {
+            const int32_t *w = tables->weight[line][q];
+            int32_t *score = &batch->score[q][start];
+            for (int i = 0; i < n; i++) {
+                score[i] += w[key[i]];
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint64_t lo = 0, hi = 0;
+        for (int p = 0; p < np; p++) {
+            lo |= batch->lo[p][start + i];
+            hi |= batch->hi[p][start + i];
+        }
+        int full = lo == tables->full_lo && hi == tables->full_hi;
+        batch->winner[start + i] = (signed char)(won[i] - 1);
+        batch->status[start + i] = won[i] ? BATCH_WIN : (full ? BATCH_DRAW : BATCH_ONGOING);
+    }
+}
+
+
+//Evaluate positions [begin, end) one cache-sized block at a time, so each
+//block stays in L1 while it is swept once per line
+
+__attribute__((target_clones("avx2", "popcnt", "default")))
+static void evaluate_range(const BatchTables *tables, PositionBatch *batch, int begin, int end) {
+    for (int start = begin; start < end; start += BATCH_BLOCK) {
+        int stop = start + BATCH_BLOCK < end ? start + BATCH_BLOCK : end;
+        if (batch->num_players == 2) {
+            evaluate_block(tables, batch, start, stop, 2);
+        } else {
+            evaluate_block(tables, batch, start, stop, 3);
+        }
+    }
+}
+
+static void* evaluate_thread(void *arg) {
+    BatchSlice *slice = (BatchSlice*)arg;
+    evaluate_range(slice->tables, slice->batch, slice->begin, slice->end);
+    return NULL;
+}
+
+
+//Win/draw/ongoing status and every player's evaluation for all positions,
+//large batches are split across up to `threads` threads
+
+void batch_evaluate(const Engine *engine, PositionBatch *batch, int threads) {
+    static _Thread_local BatchTables tables;
+    pthread_t ids[64];
+    int created[64] = {0};
+    BatchSlice slices[64];
+
+    build_tables(engine, batch->num_players, &tables);
+
+    if (threads > 64) threads = 64;
+    if (threads < 2 || batch->count < BATCH_PARALLEL_MIN) {
+        evaluate_range(&tables, batch, 0, batch->count);
+        return;
+    }
+
+    // Slices are whole blocks so no two threads share a cache line of output
+    int blocks = (batch->count + BATCH_BLOCK - 1) / BATCH_BLOCK;
+    for (int t = 0; t < threads; t++) {
+        slices[t].tables = &tables;
+        slices[t].batch = batch;
+        slices[t].begin = (int)((long)blocks * t / threads) * BATCH_BLOCK;
+        slices[t].end = (int)((long)blocks * (t + 1) / threads) * BATCH_BLOCK;
+        if (slices[t].end > batch->count) slices[t].end = batch->count;
+
+        if (t > 0) {
+            created[t] = pthread_create(&ids[t], NULL, evaluate_thread, &slices[t]) == 0;
+            if (!created[t]) {
+                evaluate_range(&tables, batch, slices[t].begin, slices[t].end);
+            }
+        }
+    }
+
+    evaluate_range(&tables, batch, slices[0].begin, slices[0].end);
+    for (int t = 1; t < threads; t++) {
+        if (created[t]) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+}
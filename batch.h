@@ -0,0 +1,37 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "engine.h"
+
+// Constants
+#define BATCH_BLOCK 256
+#define BATCH_PARALLEL_MIN 65536
+
+// Position status returned by batch_evaluate
+#define BATCH_ONGOING 0
+#define BATCH_WIN 1
+#define BATCH_DRAW 2
+
+// Structure-of-arrays batch: bitboards of every position stored contiguously
+// per player and word (cells 0-63 in lo, 64-99 in hi), results likewise
+typedef struct {
+    int size;
+    int num_players;
+    int count;
+    int capacity;
+    uint64_t *lo[MAX_PLAYERS];
+    uint64_t *hi[MAX_PLAYERS];
+    unsigned char *status;
+    signed char *winner;
+    int32_t *score[MAX_PLAYERS];
+} PositionBatch;
+
+// Function prototypes
+PositionBatch* batch_create(int size, int num_players, int capacity);
+void batch_destroy(PositionBatch *batch);
+void batch_clear(PositionBatch *batch);
+int batch_push(PositionBatch *batch, const Position *pos);
+void batch_evaluate(const Engine *engine, PositionBatch *batch, int threads);
+
+
+#endif
@@ -0,0 +1,125 @@
+// Throughput benchmark for the batched position evaluation (batch.c)
+//
+// Build: gcc -O2 -pthread bench_batch.c batch.c engine.c order.c eval.c solver.c tt.c rng.c stats.c -o bench_batch
+// Usage: bench_batch [positions] [threads]
+
+#include <unistd.h>
+#include "batch.h"
+#include "eval.h"
+
+// Constants
+#define BENCH_RUNS 3
+
+
+//Random positions: a random game stopped at a random ply
+
+static Position* random_positions(Engine *engine, int count, Rng *rng) {
+    Position *positions = (Position*)malloc((size_t)count * sizeof(Position));
+    if (!positions) {
+        printf("Memory allocation failed!\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        Position *pos = &positions[i];
+        position_init(engine, pos);
+        int plies = (int)rng_below(rng, (uint32_t)pos->empty + 1);
+        for (int k = 0; k < plies; k++) {
+            if (position_make(engine, pos, position_random_move(pos, rng))) {
+                break;
+            }
+        }
+    }
+
+    return positions;
+}
+
+
+//One position at a time, as the game core does it; returns the number of mismatches
+
+static int scalar_check(Engine *engine, const Position *positions, PositionBatch *batch, int count, double *seconds) {
+    struct timespec started;
+    int mismatches = 0;
+    volatile int32_t sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int i = 0; i < count; i++) {
+        const Position *pos = &positions[i];
+        int winner = -1;
+
+        for (int line = 0; line < engine->num_lines && winner < 0; line++) {
+            for (int p = 0; p < pos->num_players; p++) {
+                if (pos->line_count[line][p] == pos->size) winner = p;
+            }
+        }
+        int status = winner >= 0 ? BATCH_WIN : (pos->empty == 0 ? BATCH_DRAW : BATCH_ONGOING);
+
+        for (int q = 0; q < pos->num_players; q++) {
+            int32_t score = eval_refresh(engine, pos, q);
+            sink += score;
+            if (batch && score != batch->score[q][i]) mismatches++;
+        }
+        if (batch && (status != batch->status[i] || winner != batch->winner[i])) mismatches++;
+    }
+    *seconds = elapsed_ms_since(&started) / 1000.0;
+
+    return mismatches;
+}
+
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int threads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    Rng rng;
+
+    if (count < 1 || threads < 1) {
+        printf("Usage: bench_batch [positions] [threads]\n");
+        return 1;
+    }
+
+    rng_seed(&rng, 12345, 0);
+    printf("%-6s %-8s %14s %14s %14s %10s\n", "Board", "Players", "Scalar Mpos/s",
+           "Batch Mpos/s", "Threads Mpos/s", "Mismatch");
+
+    for (int np = 2; np <= MAX_PLAYERS; np++) {
+        for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+            Engine *engine = engine_create(size, np, 0);
+            Position *positions = engine ? random_positions(engine, count, &rng) : NULL;
+            PositionBatch *batch = batch_create(size, np, count);
+            if (!positions || !batch) {
+                return 1;
+            }
+
+            for (int i = 0; i < count; i++) {
+                batch_push(batch, &positions[i]);
+            }
+
+            // Best of a few runs, the first one also pages the arrays in
+            double single = 1e30, parallel = 1e30;
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                struct timespec started;
+                clock_gettime(CLOCK_MONOTONIC, &started);
+                batch_evaluate(engine, batch, 1);
+                double seconds = elapsed_ms_since(&started) / 1000.0;
+                if (seconds < single) single = seconds;
+
+                clock_gettime(CLOCK_MONOTONIC, &started);
+                batch_evaluate(engine, batch, threads);
+                seconds = elapsed_ms_since(&started) / 1000.0;
+                if (seconds < parallel) parallel = seconds;
+            }
+
+            double scalar;
+            int mismatches = scalar_check(engine, positions, batch, count, &scalar);
+
+            printf("%2dx%-3d %-8d %14.1f %14.1f %14.1f %10d\n", size, size, np,
+                   count / scalar / 1e6, count / single / 1e6, count / parallel / 1e6, mismatches);
+
+            batch_destroy(batch);
+            free(positions);
+            engine_destroy(engine);
+        }
+    }
+
+    return 0;
+}
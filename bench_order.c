@@ -0,0 +1,126 @@
+// Benchmark for the search's move ordering (order.c): the same positions are
+// searched to a fixed depth with ordering on and off
+//
+// Build: gcc -O2 -pthread bench_order.c engine.c order.c eval.c solver.c tt.c rng.c stats.c -o bench_order
+// Usage: bench_order [games] [plies]
+// Each game is a random opening of a few moves followed by [plies] random moves;
+// its positions are searched one after another, as in a game, so killers,
+// history and the previous principal variation carry over between searches.
+
+#include "order.h"
+
+// Constants
+#define BENCH_OPENING 2
+
+
+// Totals of one configuration
+typedef struct {
+    long long nodes;
+    double ms;
+    double ebf;
+    long long cutoffs;
+    long long first_cutoffs;
+    int searches;
+    int ebf_searches;
+} BenchTotals;
+
+
+//Search every position of every game with ordering on or off; scores are
+//written to (or, when check is set, compared against) scores[]
+
+static int run_games(Engine *engine, int enabled, int games, int plies, int depth, uint64_t seed,
+                     int *scores, int check, BenchTotals *totals) {
+    int mismatches = 0, index = 0;
+    Rng rng;
+
+    rng_seed(&rng, seed, 0);
+    memset(totals, 0, sizeof(BenchTotals));
+    engine->order.enabled = enabled;
+    engine->max_depth = depth;
+    engine->solve_empty = 0;
+
+    for (int g = 0; g < games; g++) {
+        Position pos;
+        position_init(engine, &pos);
+        tt_clear(&engine->tt);
+        order_clear(&engine->order);
+
+        for (int ply = 0; ply < BENCH_OPENING + plies && pos.empty > 0; ply++) {
+            if (ply >= BENCH_OPENING) {
+                SearchResult result;
+                struct timespec started;
+
+                clock_gettime(CLOCK_MONOTONIC, &started);
+                engine_search(engine, &pos, pos.to_move, -1, &result);
+                totals->ms += elapsed_ms_since(&started);
+                totals->nodes += result.nodes;
+                totals->cutoffs += engine->order.cutoffs;
+                totals->first_cutoffs += engine->order.first_cutoffs;
+                totals->searches++;
+                if (result.ebf > 0) {
+                    totals->ebf += result.ebf;
+                    totals->ebf_searches++;
+                }
+
+                if (check && scores[index] != result.score) mismatches++;
+                scores[index++] = result.score;
+            }
+
+            if (position_make(engine, &pos, position_random_move(&pos, &rng))) {
+                break;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+
+static void print_totals(int size, int np, int depth, const char *mode, const BenchTotals *t) {
+    printf("%2dx%-3d %-8d %-6d %-9s %12lld %10.1f %8.2f %10.1f%%\n", size, size, np, depth, mode,
+           t->nodes / (t->searches ? t->searches : 1), t->ms,
+           t->ebf_searches ? t->ebf / t->ebf_searches : 0.0,
+           t->cutoffs ? 100.0 * t->first_cutoffs / t->cutoffs : 0.0);
+}
+
+
+int main(int argc, char **argv) {
+    int games = argc > 1 ? atoi(argv[1]) : 20;
+    int plies = argc > 2 ? atoi(argv[2]) : 4;
+    static const int depths[][2] = {{3, 9}, {4, 7}, {5, 5}, {6, 4}};
+
+    if (games < 1 || plies < 1) {
+        printf("Usage: bench_order [games] [plies]\n");
+        return 1;
+    }
+
+    printf("%-6s %-8s %-6s %-9s %12s %10s %8s %11s\n", "Board", "Players", "Depth", "Ordering",
+           "Nodes/search", "Total ms", "EBF", "First cut");
+
+    for (int np = 2; np <= MAX_PLAYERS; np++) {
+        for (size_t k = 0; k < sizeof(depths) / sizeof(depths[0]); k++) {
+            int size = depths[k][0], depth = depths[k][1];
+            Engine *engine = engine_create(size, np, 0);
+            int *scores = (int*)malloc((size_t)games * plies * sizeof(int));
+            if (!engine || !scores) {
+                printf("Memory allocation failed!\n");
+                return 1;
+            }
+
+            BenchTotals off, on;
+            uint64_t seed = 1000 * (uint64_t)size + np;
+            run_games(engine, 0, games, plies, depth, seed, scores, 0, &off);
+            int mismatches = run_games(engine, 1, games, plies, depth, seed, scores, 1, &on);
+
+            print_totals(size, np, depth, "off", &off);
+            print_totals(size, np, depth, "on", &on);
+            printf("%-33s %11.2fx fewer nodes, %d score mismatches\n", "",
+                   on.nodes ? (double)off.nodes / on.nodes : 0.0, mismatches);
+
+            free(scores);
+            engine_destroy(engine);
+        }
+    }
+
+    return 0;
+}
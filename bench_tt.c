@@ -0,0 +1,94 @@
+// Benchmark for the transposition table (tt.c): random probes and stores
+// across table sizes, with and without prefetching, and clearing time
+//
+// Build: gcc -O2 -pthread bench_tt.c tt.c rng.c stats.c -o bench_tt
+// Usage: bench_tt [max MB] [operations]
+// Build with -DTT_HUGE_PAGES=0 to compare against normal pages.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tt.h"
+#include "rng.h"
+
+// Constants
+#define BENCH_PREFETCH_AHEAD 8
+
+
+static double seconds_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+//Store then probe random keys; with prefetch set, each bucket is requested
+//a few operations before it is used, as the search does after making a move
+
+static double run_keys(TransTable *tt, const uint64_t *keys, int count, int prefetch, int *hits) {
+    struct timespec started;
+    TTEntry entry;
+
+    *hits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int i = 0; i < count; i++) {
+        if (prefetch && i + BENCH_PREFETCH_AHEAD < count) {
+            tt_prefetch(tt, keys[i + BENCH_PREFETCH_AHEAD]);
+        }
+        tt_store(tt, keys[i], i, i & 15, TT_EXACT, i & 63);
+    }
+    for (int i = 0; i < count; i++) {
+        if (prefetch && i + BENCH_PREFETCH_AHEAD < count) {
+            tt_prefetch(tt, keys[i + BENCH_PREFETCH_AHEAD]);
+        }
+        if (tt_probe(tt, keys[i], &entry) && entry.score == i) (*hits)++;
+    }
+
+    return seconds_since(&started) * 1e9 / (2.0 * count);
+}
+
+
+int main(int argc, char **argv) {
+    size_t max_mb = argc > 1 ? (size_t)atoi(argv[1]) : 1024;
+    int count = argc > 2 ? atoi(argv[2]) : 4000000;
+    Rng rng;
+
+    uint64_t *keys = (uint64_t*)malloc((size_t)(count > 0 ? count : 1) * sizeof(uint64_t));
+    if (!keys || max_mb < 1 || count < 1) {
+        printf("Usage: bench_tt [max MB] [operations]\n");
+        return 1;
+    }
+
+    rng_seed(&rng, 12345, 0);
+    for (int i = 0; i < count; i++) {
+        keys[i] = rng_next(&rng);
+    }
+
+    printf("%-8s %-6s %12s %12s %10s %10s\n", "Table MB", "Huge", "ns/op", "Prefetch", "Hits %", "Clear ms");
+
+    for (size_t mb = 1; mb <= max_mb; mb *= 4) {
+        TransTable tt;
+        int hits;
+        if (!tt_init(&tt, mb)) {
+            return 1;
+        }
+
+        // Touch every page first, so page faults are not part of the timing
+        struct timespec started;
+        tt_clear(&tt);
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        tt_clear(&tt);
+        double clear_ms = seconds_since(&started) * 1e3;
+
+        double plain = run_keys(&tt, keys, count, 0, &hits);
+        tt_clear(&tt);
+        double ahead = run_keys(&tt, keys, count, 1, &hits);
+
+        printf("%-8zu %-6s %12.1f %12.1f %10.1f %10.2f\n", mb, tt.huge_pages ? "yes" : "no",
+               plain, ahead, 100.0 * hits / count, clear_ms);
+        tt_free(&tt);
+    }
+
+    free(keys);
+    return 0;
+}
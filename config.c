@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "config.h"
+
+// Config files being read, outermost first (a "config" setting nests another)
+static const char *include_stack[CONFIG_MAX_INCLUDES];
+static int include_depth = 0;
+
+
+//No size, players or seats given yet, logging to log_path, snapshots left to the program
+
+void config_defaults(Config *config, const char *log_path) {
+    memset(config, 0, sizeof(Config));
+    config->log_enabled = 1;
+    config->snapshot_enabled = -1;
+    config->stats_enabled = 1;
+    snprintf(config->log_path, sizeof(config->log_path), "%s", log_path);
+}
+
+
+//Read the number of a dN or tN engine, 0 unless it is all digits and 1..max
+
+static int engine_number(const char *digits, long max) {
+    char *end;
+    long n = strtol(digits, &end, 10);
+    return isdigit((unsigned char)digits[0]) && !*end && n >= 1 && n <= max ? (int)n : 0;
+}
+
+
+//Parse a computer engine: random, search (default think time), dN (depth N,
+//at most CONFIG_MAX_DEPTH, as deep as the largest board) or tN (N ms)
+
+static int parse_engine(SeatConfig *seat, const char *text) {
+    seat->random_play = 0;
+    seat->depth = 0;
+    seat->think_ms = 0;
+
+    if (strcmp(text, "random") == 0) {
+        seat->random_play = 1;
+        return 1;
+    }
+    if (strcmp(text, "search") == 0 || text[0] == '\0') {
+        return 1;
+    }
+    if (text[0] == 'd' && engine_number(text + 1, CONFIG_MAX_DEPTH)) {
+        seat->depth = engine_number(text + 1, CONFIG_MAX_DEPTH);
+        seat->think_ms = -1;
+        return 1;
+    }
+    if (text[0] == 't' && engine_number(text + 1, CONFIG_MAX_THINK_MS)) {
+        seat->think_ms = engine_number(text + 1, CONFIG_MAX_THINK_MS);
+        return 1;
+    }
+
+    printf("Unknown engine '%s' (use random, search, dN with N 1-%d or tN with N 1-%d ms)\n",
+           text, CONFIG_MAX_DEPTH, CONFIG_MAX_THINK_MS);
+    return 0;
+}
+
+
+//Parse a seat: human[:NAME] or computer[:ENGINE[:NAME]]
+
+static int parse_seat(SeatConfig *seat, const char *text) {
+    char buf[CONFIG_PATH_LEN];
+    snprintf(buf, sizeof(buf), "%s", text);
+
+    char *engine = NULL, *name = NULL;
+    char *colon = strchr(buf, ':');
+    if (colon) {
+        *colon = '\0';
+        engine = colon + 1;
+    }
+
+    memset(seat, 0, sizeof(SeatConfig));
+    if (strcmp(buf, "human") == 0) {
+        seat->type = SEAT_HUMAN;
+        name = engine;
+    } else if (strcmp(buf, "computer") == 0) {
+        seat->type = SEAT_COMPUTER;
+        if (engine && (colon = strchr(engine, ':')) != NULL) {
+            *colon = '\0';
+            name = colon + 1;
+        }
+        if (!parse_engine(seat, engine ? engine : "")) {
+            return 0;
+        }
+    } else {
+        printf("Unknown seat '%s' (use human[:NAME] or computer[:ENGINE[:NAME]])\n", text);
+        return 0;
+    }
+
+    if (name) {
+        if (strlen(name) >= sizeof(seat->name) || strchr(name, ' ')) {
+            printf("Invalid player name '%s'\n", name);
+            return 0;
+        }
+        strcpy(seat->name, name);
+    }
+    return 1;
+}
+
+
+//Apply one setting, keys are the long option names without the dashes
+
+int config_set(Config *config, const char *key, const char *value) {
+    if (strcmp(key, "size") == 0) {
+        config->size = atoi(value);
+        if (config->size <= 0) {
+            printf("Invalid board size '%s'\n", value);
+            return 0;
+        }
+    } else if (strcmp(key, "players") == 0) {
+        config->num_players = atoi(value);
+        if (config->num_players < 2 || config->num_players > CONFIG_MAX_SEATS) {
+            printf("Number of players must be 2 or %d!\n", CONFIG_MAX_SEATS);
+            return 0;
+        }
+    } else if (strncmp(key, "seat", 4) == 0 && key[4] >= '1' && key[4] < '1' + CONFIG_MAX_SEATS && !key[5]) {
+        return parse_seat(&config->seats[key[4] - '1'], value);
+    } else if (strcmp(key, "seed") == 0) {
+        config->seed = strtoull(value, NULL, 10);
+        config->has_seed = 1;
+    } else if (strcmp(key, "log") == 0) {
+        config->log_enabled = strcmp(value, "off") != 0;
+        if (config->log_enabled) {
+            snprintf(config->log_path, sizeof(config->log_path), "%s", value);
+        }
+    } else if (strcmp(key, "snapshot") == 0) {
+        config->snapshot_enabled = strcmp(value, "off") != 0;
+        if (config->snapshot_enabled) {
+            snprintf(config->snapshot_path, sizeof(config->snapshot_path), "%s", value);
+        }
+    } else if (strcmp(key, "stats") == 0) {
+        config->stats_enabled = strcmp(value, "off") != 0;
+        if (config->stats_enabled) {
+            snprintf(config->stats_path, sizeof(config->stats_path), "%s", value);
+        }
+    } else if (strcmp(key, "config") == 0) {
+        return config_load(config, value);
+    } else {
+        printf("Unknown setting '%s'\n", key);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+//Read "key = value" lines, blank lines and lines starting with # are skipped;
+//a file that includes itself, directly or not, is an error
+
+int config_load(Config *config, const char *path) {
+    char line[CONFIG_PATH_LEN + 32];
+    int line_number = 0;
+
+    for (int i = 0; i < include_depth; i++) {
+        if (strcmp(include_stack[i], path) == 0) {
+            printf("Config file '%s' includes itself\n", path);
+            return 0;
+        }
+    }
+    if (include_depth == CONFIG_MAX_INCLUDES) {
+        printf("Config files nested more than %d deep at '%s'\n", CONFIG_MAX_INCLUDES, path);
+        return 0;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("Could not open config file '%s'\n", path);
+        return 0;
+    }
+    include_stack[include_depth++] = path;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char *key = line;
+        while (isspace((unsigned char)*key)) key++;
+        if (*key == '\0' || *key == '#') {
+            continue;
+        }
+
+        char *equals = strchr(key, '=');
+        if (!equals) {
+            printf("%s:%d: expected key = value\n", path, line_number);
+            fclose(file);
+            include_depth--;
+            return 0;
+        }
+
+        // Trim both sides of the key and the value
+        char *value = equals + 1;
+        char *end = equals;
+        while (end > key && isspace((unsigned char)end[-1])) end--;
+        *end = '\0';
+        while (isspace((unsigned char)*value)) value++;
+        end = value + strlen(value);
+        while (end > value && isspace((unsigned char)end[-1])) end--;
+        *end = '\0';
+
+        if (!config_set(config, key, value)) {
+            printf("%s:%d: invalid setting\n", path, line_number);
+            fclose(file);
+            include_depth--;
+            return 0;
+        }
+    }
+
+    fclose(file);
+    include_depth--;
+    return 1;
+}
+
+
+//Apply --key value options in order, so later options override a --config file
+
+int config_parse_args(Config *config, int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            config_usage(argv[0]);
+            return 0;
+        }
+        if (strcmp(arg, "--no-log") == 0) {
+            config->log_enabled = 0;
+            continue;
+        }
+        if (strcmp(arg, "--no-snapshot") == 0) {
+            config->snapshot_enabled = 0;
+            continue;
+        }
+        if (strcmp(arg, "--no-stats") == 0) {
+            config->stats_enabled = 0;
+            continue;
+        }
+        if (strncmp(arg, "--", 2) != 0) {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+        if (i + 1 == argc) {
+            printf("Missing value for %s\n", arg);
+            return 0;
+        }
+        if (!config_set(config, arg + 2, argv[++i])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+//Everything needed to start without asking: size, players, and every seat's
+//type, with names for the human seats
+
+int config_complete(const Config *config) {
+    if (config->size <= 0 || config->num_players <= 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < config->num_players; i++) {
+        const SeatConfig *seat = &config->seats[i];
+        if (seat->type == SEAT_UNSET || (seat->type == SEAT_HUMAN && !seat->name[0])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+//Print the command line options
+
+void config_usage(const char *program) {
+    printf("Usage: %s [options]\n"
+           "  --size N          board size\n"
+           "  --players P       number of players (2-%d)\n"
+           "  --seatK SEAT      seat K (1-%d): human[:NAME] or computer[:ENGINE[:NAME]],\n"
+           "                    ENGINE is random, search, dN (depth N) or tN (N ms)\n"
+           "  --seed S          seed of the game's random stream\n"
+           "  --log PATH|off    game log file, or no log\n"
+           "  --no-log          same as --log off\n"
+           "  --snapshot PATH|off\n"
+           "                    file an interrupted game is resumed from, or none (default\n"
+           "                    game_snapshot.bin, only when something is asked for)\n"
+           "  --no-snapshot     same as --snapshot off\n"
+           "  --stats PATH|off  metrics file in Prometheus text format (default\n"
+           "                    game_stats.prom), or none\n"
+           "  --no-stats        same as --stats off\n"
+           "  --config FILE     read settings from FILE (key = value lines, same keys)\n"
+           "Anything not given is asked for; with everything given the game starts at once.\n",
+           program, CONFIG_MAX_SEATS, CONFIG_MAX_SEATS);
+}
@@ -0,0 +1,56 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+
+// Constants (kept separate from the game headers so both programs can use this)
+#define CONFIG_MAX_SEATS 3
+#define CONFIG_NAME_LEN 50
+#define CONFIG_PATH_LEN 256
+#define CONFIG_MAX_INCLUDES 8
+#define CONFIG_MAX_DEPTH 100
+#define CONFIG_MAX_THINK_MS 3600000
+
+// Seat types, SEAT_UNSET is asked for interactively
+typedef enum {
+    SEAT_UNSET,
+    SEAT_HUMAN,
+    SEAT_COMPUTER
+} SeatType;
+
+// One seat: type, computer engine and name (empty name is asked for or defaulted)
+typedef struct {
+    SeatType type;
+    int random_play;
+    int depth;
+    int think_ms;
+    char name[CONFIG_NAME_LEN];
+} SeatConfig;
+
+// Startup settings from the command line and config files, 0 or empty when not given
+// (snapshot_enabled is -1 until a snapshot setting is given, an empty stats_path
+// is the program's default file)
+typedef struct {
+    int size;
+    int num_players;
+    SeatConfig seats[CONFIG_MAX_SEATS];
+    int has_seed;
+    uint64_t seed;
+    int log_enabled;
+    char log_path[CONFIG_PATH_LEN];
+    int snapshot_enabled;
+    char snapshot_path[CONFIG_PATH_LEN];
+    int stats_enabled;
+    char stats_path[CONFIG_PATH_LEN];
+} Config;
+
+// Function prototypes
+void config_defaults(Config *config, const char *log_path);
+int config_set(Config *config, const char *key, const char *value);
+int config_load(Config *config, const char *path);
+int config_parse_args(Config *config, int argc, char **argv);
+int config_complete(const Config *config);
+void config_usage(const char *program);
+
+
+#endif
@@ -0,0 +1,466 @@
+#include "engine.h"
+#include "eval.h"
+#include "order.h"
+#include "solver.h"
+#include "stats.h"
+
+
+//Milliseconds elapsed since a monotonic time stamp
+
+double elapsed_ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 +
+           (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+
+//Create an engine with line tables and hashing keys for a board
+
+Engine* engine_create(int size, int num_players, size_t tt_mb) {
+    Engine *engine = (Engine*)calloc(1, sizeof(Engine));
+    if (!engine) {
+        printf("Memory allocation failed!\n");
+        return NULL;
+    }
+    STATS_INC(allocations);
+
+    engine->size = size;
+    engine->num_players = num_players;
+    engine->think_ms = ENGINE_THINK_MS;
+    engine->solve_empty = SOLVER_EMPTY_CELLS;
+    atomic_init(&engine->stop, 0);
+
+    // Rows, columns and both diagonals
+    int l = 0;
+    for (int i = 0; i < size; i++, l++) {
+        for (int j = 0; j < size; j++) {
+            engine->line_cells[l][j] = i * size + j;
+        }
+    }
+    for (int j = 0; j < size; j++, l++) {
+        for (int i = 0; i < size; i++) {
+            engine->line_cells[l][i] = i * size + j;
+        }
+    }
+    for (int i = 0; i < size; i++) {
+        engine->line_cells[l][i] = i * size + i;
+        engine->line_cells[l + 1][i] = i * size + (size - 1 - i);
+    }
+    l += 2;
+    engine->num_lines = l;
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int k = 0; k < size; k++) {
+            int cell = engine->line_cells[line][k];
+            engine->cell_lines[cell][engine->cell_num_lines[cell]++] = line;
+        }
+    }
+
+    eval_default_weights(engine);
+
+    // Fixed seed so hash keys are the same in every run
+    Rng keys;
+    rng_seed(&keys, 0x7469637461634BULL, 0);
+    for (int cell = 0; cell < MAX_CELLS; cell++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            engine->zobrist[cell][p] = rng_next(&keys);
+        }
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        engine->zobrist_side[p] = rng_next(&keys);
+        engine->zobrist_root[p] = rng_next(&keys);
+    }
+
+    order_init(engine);
+
+    if (!tt_init(&engine->tt, tt_mb)) {
+        free(engine);
+        return NULL;
+    }
+    if (!tt_init(&engine->solved, tt_mb / 4)) {
+        tt_free(&engine->tt);
+        free(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+
+//Release the engine and its table
+
+void engine_destroy(Engine *engine) {
+    if (engine) {
+        tt_free(&engine->tt);
+        tt_free(&engine->solved);
+        free(engine);
+    }
+}
+
+
+//Forget what earlier games taught the search, solved positions stay valid
+
+void engine_new_game(Engine *engine) {
+    tt_clear(&engine->tt);
+    order_clear(&engine->order);
+}
+
+
+//Set up an empty position with the first player to move
+
+void position_init(Engine *engine, Position *pos) {
+    memset(pos, 0, sizeof(Position));
+    pos->size = engine->size;
+    pos->num_players = engine->num_players;
+    pos->to_move = 0;
+    pos->empty = engine->size * engine->size;
+    pos->hash = engine->zobrist_side[0];
+}
+
+
+//Copy the board of a game into a search position
+
+void position_from_game(Engine *engine, Position *pos, Game *game) {
+    position_init(engine, pos);
+
+    for (int i = 0; i < game->size; i++) {
+        for (int j = 0; j < game->size; j++) {
+            for (int p = 0; p < game->num_players; p++) {
+                if (game->board[i][j] == game->players[p].symbol) {
+                    pos->to_move = p;
+                    position_make(engine, pos, i * game->size + j);
+                    break;
+                }
+            }
+        }
+    }
+
+    pos->hash ^= engine->zobrist_side[pos->to_move] ^ engine->zobrist_side[game->current_player];
+    pos->to_move = game->current_player;
+}
+
+
+//Update every player's evaluation for player p adding (sign 1) or removing
+//(sign -1) a piece on a line, given the line counts without that piece
+
+static void update_eval(Engine *engine, Position *pos, int line, int p, int sign) {
+    const unsigned char *count = pos->line_count[line];
+    int np = pos->num_players;
+    int others = 0, other = -1;
+
+    for (int o = 0; o < np; o++) {
+        if (o != p && count[o]) {
+            others++;
+            other = o;
+        }
+    }
+
+    if (others == 0) {
+        // The line stays p's alone, one piece fuller
+        int c = count[p];
+        for (int q = 0; q < np; q++) {
+            const int16_t *w = engine->weights[line][(p - q + np) % np];
+            pos->eval[q] += sign * (w[c + 1] - w[c]);
+        }
+    } else if (others == 1 && count[p] == 0) {
+        // p blocks a line that belonged to one other player
+        for (int q = 0; q < np; q++) {
+            pos->eval[q] -= sign * engine->weights[line][(other - q + np) % np][count[other]];
+        }
+    }
+}
+
+
+//Place the side to move on a cell, returns 1 if that completes a line
+
+int position_make(Engine *engine, Position *pos, int cell) {
+    int p = pos->to_move;
+    int next = (p + 1) % pos->num_players;
+    int won = 0;
+
+    pos->cells[cell] = (unsigned char)(p + 1);
+    pos->hash ^= engine->zobrist[cell][p] ^ engine->zobrist_side[p] ^ engine->zobrist_side[next];
+    pos->empty--;
+
+    for (int k = 0; k < engine->cell_num_lines[cell]; k++) {
+        int line = engine->cell_lines[cell][k];
+        update_eval(engine, pos, line, p, 1);
+        if (++pos->line_count[line][p] == pos->size) {
+            won = 1;
+        }
+    }
+
+    pos->to_move = next;
+    return won;
+}
+
+
+//Take back the move on a cell
+
+void position_unmake(Engine *engine, Position *pos, int cell) {
+    int p = pos->cells[cell] - 1;
+
+    for (int k = 0; k < engine->cell_num_lines[cell]; k++) {
+        int line = engine->cell_lines[cell][k];
+        pos->line_count[line][p]--;
+        update_eval(engine, pos, line, p, -1);
+    }
+
+    pos->hash ^= engine->zobrist[cell][p] ^ engine->zobrist_side[p] ^ engine->zobrist_side[pos->to_move];
+    pos->cells[cell] = 0;
+    pos->empty++;
+    pos->to_move = p;
+}
+
+
+//Pick one of the empty cells uniformly at random
+
+int position_random_move(const Position *pos, Rng *rng) {
+    int pick = (int)rng_below(rng, (uint32_t)pos->empty);
+
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (!pos->cells[cell] && pick-- == 0) {
+            return cell;
+        }
+    }
+    return -1;
+}
+
+
+//Static evaluation from the point of view of the root player
+
+int engine_evaluate(Engine *engine, const Position *pos, int root) {
+    (void)engine;
+    return pos->eval[root];
+}
+
+
+//Convert mate scores between root-relative and node-relative form
+
+static int score_to_tt(int score, int ply) {
+    if (score > WIN_SCORE - MAX_PLY) return score + ply;
+    if (score < -WIN_SCORE + MAX_PLY) return score - ply;
+    return score;
+}
+
+static int score_from_tt(int score, int ply) {
+    if (score > WIN_SCORE - MAX_PLY) return score - ply;
+    if (score < -WIN_SCORE + MAX_PLY) return score + ply;
+    return score;
+}
+
+
+//Has the search run out of time or been cancelled from another thread
+
+int engine_stopped(Engine *engine) {
+    return engine->timed_out || atomic_load_explicit(&engine->stop, memory_order_relaxed);
+}
+
+
+//Check the clock every thousand nodes
+
+int engine_should_stop(Engine *engine) {
+    if ((engine->nodes & 1023) == 0 && engine->has_deadline) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > engine->deadline.tv_sec ||
+            (now.tv_sec == engine->deadline.tv_sec && now.tv_nsec >= engine->deadline.tv_nsec)) {
+            engine->timed_out = 1;
+        }
+    }
+    return engine_stopped(engine);
+}
+
+
+//Paranoid alpha-beta: the root player maximizes, everyone else minimizes
+
+static int search(Engine *engine, Position *pos, int root, int depth, int ply, int alpha, int beta) {
+    engine->nodes++;
+    if (engine_should_stop(engine)) {
+        return 0;
+    }
+
+    if (pos->empty == 0) {
+        return 0; // Board full, draw
+    }
+
+    if (depth == 0) {
+        return engine_evaluate(engine, pos, root);
+    }
+
+    uint64_t key = pos->hash ^ engine->zobrist_root[root];
+    int tt_move = -1;
+    TTEntry entry;
+    if (tt_probe(&engine->tt, key, &entry)) {
+        tt_move = entry.move;
+        if (entry.depth >= depth) {
+            int score = score_from_tt(entry.score, ply);
+            if (entry.flag == TT_EXACT) return score;
+            if (entry.flag == TT_LOWER && score >= beta) return score;
+            if (entry.flag == TT_UPPER && score <= alpha) return score;
+        }
+    }
+
+    int maximizing = pos->to_move == root;
+    int orig_alpha = alpha, orig_beta = beta;
+    int best = maximizing ? -WIN_SCORE - 1 : WIN_SCORE + 1;
+    int best_move = -1;
+    int moves[MAX_CELLS], scores[MAX_CELLS];
+    int count = order_moves(engine, pos, key, ply, tt_move, moves, scores);
+
+    for (int i = 0; i < count; i++) {
+        int cell = order_next(moves, scores, count, i);
+        int mover = pos->to_move;
+        int score;
+        if (position_make(engine, pos, cell)) {
+            score = mover == root ? WIN_SCORE - (ply + 1) : -WIN_SCORE + (ply + 1);
+        } else {
+            if (depth > 1) tt_prefetch(&engine->tt, pos->hash ^ engine->zobrist_root[root]);
+            score = search(engine, pos, root, depth - 1, ply + 1, alpha, beta);
+        }
+        position_unmake(engine, pos, cell);
+
+        if (engine_stopped(engine)) {
+            return 0;
+        }
+
+        if (maximizing ? score > best : score < best) {
+            best = score;
+            best_move = cell;
+        }
+        if (maximizing && best > alpha) alpha = best;
+        if (!maximizing && best < beta) beta = best;
+        if (alpha >= beta) {
+            order_cutoff(&engine->order, pos, ply, depth, cell, i);
+            break;
+        }
+    }
+
+    int flag = TT_EXACT;
+    if (best <= orig_alpha) flag = TT_UPPER;
+    else if (best >= orig_beta) flag = TT_LOWER;
+    tt_store(&engine->tt, key, score_to_tt(best, ply), depth, flag, best_move);
+
+    return best;
+}
+
+
+//Follow hash moves from the root to rebuild the principal variation
+
+static void extract_pv(Engine *engine, const Position *root_pos, int root, SearchResult *result) {
+    Position pos = *root_pos;
+    result->pv_len = 0;
+
+    while (result->pv_len < result->depth && pos.empty > 0) {
+        TTEntry entry;
+        if (!tt_probe(&engine->tt, pos.hash ^ engine->zobrist_root[root], &entry) ||
+            entry.move < 0 || pos.cells[entry.move]) {
+            break;
+        }
+        result->pv[result->pv_len++] = entry.move;
+        if (position_make(engine, &pos, entry.move)) {
+            break;
+        }
+    }
+}
+
+
+//Stop searching think_ms after start
+
+static void set_deadline(Engine *engine, const struct timespec *start, int think_ms) {
+    engine->deadline = *start;
+    engine->deadline.tv_sec += think_ms / 1000;
+    engine->deadline.tv_nsec += (long)(think_ms % 1000) * 1000000L;
+    if (engine->deadline.tv_nsec >= 1000000000L) {
+        engine->deadline.tv_sec++;
+        engine->deadline.tv_nsec -= 1000000000L;
+    }
+}
+
+
+//Iterative deepening search up to engine->max_depth (0 for no limit),
+//think_ms < 0 searches until engine->stop is set
+
+void engine_search(Engine *engine, const Position *pos, int root, int think_ms, SearchResult *result) {
+    Position work = *pos;
+    STATS_TIMER(started);
+
+    memset(result, 0, sizeof(SearchResult));
+    result->move = -1;
+
+    engine->nodes = 0;
+    engine->timed_out = 0;
+    order_start(&engine->order);
+    tt_new_search(&engine->tt);
+    engine->has_deadline = think_ms >= 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Always have a legal move, even if the first iteration is cut short
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (!pos->cells[cell]) {
+            result->move = cell;
+            break;
+        }
+    }
+
+    // Few cells left: solve exactly with part of the time. A search limited by
+    // depth only solves when that depth reaches the end of the game anyway
+    if (pos->empty <= engine->solve_empty &&
+        (engine->has_deadline || engine->max_depth <= 0 || pos->empty <= engine->max_depth)) {
+        if (engine->has_deadline) {
+            set_deadline(engine, &start, think_ms * SOLVER_TIME_SHARE / 100);
+        }
+        if (solver_solve(engine, pos, root, result)) {
+            result->nodes = engine->nodes;
+            STATS_ADD(search_nodes, engine->nodes);
+            STATS_ADD_ELAPSED(search_usec, started);
+            return;
+        }
+        engine->timed_out = 0;
+    }
+
+    // The depth-limited search gets the whole budget, less what the solver used
+    if (engine->has_deadline) {
+        set_deadline(engine, &start, think_ms);
+    }
+
+    int max_depth = engine->max_depth > 0 && engine->max_depth < pos->empty ? engine->max_depth : pos->empty;
+    long long prev_nodes = 0;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        long long start_nodes = engine->nodes;
+        int score = search(engine, &work, root, depth, 0, -WIN_SCORE - 1, WIN_SCORE + 1);
+        if (engine_stopped(engine)) {
+            break;
+        }
+
+        TTEntry entry;
+        if (tt_probe(&engine->tt, pos->hash ^ engine->zobrist_root[root], &entry) && entry.move >= 0) {
+            result->move = entry.move;
+        }
+        result->score = score;
+        result->depth = depth;
+
+        // Effective branching factor: growth of the tree from one iteration to the next
+        if (prev_nodes > 0) {
+            result->ebf = (double)(engine->nodes - start_nodes) / prev_nodes;
+        }
+        prev_nodes = engine->nodes - start_nodes;
+
+        // A forced result will not change with more depth
+        if (score > WIN_SCORE - MAX_PLY || score < -WIN_SCORE + MAX_PLY) {
+            break;
+        }
+    }
+
+    result->nodes = engine->nodes;
+    if (engine->order.cutoffs > 0) {
+        result->first_cutoff_rate = (double)engine->order.first_cutoffs / engine->order.cutoffs;
+    }
+    extract_pv(engine, pos, root, result);
+    order_save_pv(engine, pos, root, result);
+
+    STATS_ADD(search_nodes, engine->nodes);
+    STATS_ADD_ELAPSED(search_usec, started);
+}
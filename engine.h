@@ -0,0 +1,114 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "tictactoe.h"
+#include "tt.h"
+
+// Constants
+#define MAX_CELLS (MAX_SIZE * MAX_SIZE)
+#define MAX_LINES (2 * MAX_SIZE + 2)
+#define MAX_PLY MAX_CELLS
+#define WIN_SCORE 1000000
+#define ENGINE_THINK_MS 1000
+#define ENGINE_TT_MB 16
+#define SOLVER_EMPTY_CELLS 14
+#define SOLVER_TIME_SHARE 50
+#define ORDER_KILLERS 2
+
+// Compact position used by the search (cells hold player index + 1, 0 is empty,
+// eval[q] is the evaluation for player q, kept up to date by make/unmake)
+typedef struct {
+    unsigned char cells[MAX_CELLS];
+    unsigned char line_count[MAX_LINES][MAX_PLAYERS];
+    int size;
+    int num_players;
+    int to_move;
+    int empty;
+    uint64_t hash;
+    int32_t eval[MAX_PLAYERS];
+} Position;
+
+// Result of a search
+typedef struct {
+    int move;
+    int score;
+    int depth;
+    long long nodes;
+    int pv[MAX_PLY];
+    int pv_len;
+    double ebf;
+    double first_cutoff_rate;
+} SearchResult;
+
+// Background search state while a human is thinking
+typedef struct {
+    pthread_t thread;
+    int active;
+    int root;
+    int think_ms;
+    Position pos;
+    int reply[MAX_CELLS];
+    int ready[MAX_CELLS];
+    int num_ready;
+} Ponder;
+
+// Move ordering state: killer moves per ply, history by player and cell, a
+// static prior per cell and the previous principal variation as node keys
+typedef struct {
+    int enabled;
+    int prior[MAX_CELLS];
+    int killers[MAX_PLY][ORDER_KILLERS];
+    int history[MAX_PLAYERS][MAX_CELLS];
+    uint64_t pv_keys[MAX_PLY];
+    int pv_moves[MAX_PLY];
+    int pv_len;
+    long long cutoffs;
+    long long first_cutoffs;
+} MoveOrder;
+
+// Search engine shared by every computer seat of a game
+typedef struct Engine {
+    int size;
+    int num_players;
+    int num_lines;
+    int line_cells[MAX_LINES][MAX_SIZE];
+    int cell_lines[MAX_CELLS][4];
+    int cell_num_lines[MAX_CELLS];
+    int16_t weights[MAX_LINES][MAX_PLAYERS][MAX_SIZE + 1];
+    uint64_t zobrist[MAX_CELLS][MAX_PLAYERS];
+    uint64_t zobrist_side[MAX_PLAYERS];
+    uint64_t zobrist_root[MAX_PLAYERS];
+    TransTable tt;
+    TransTable solved;
+    int solve_empty;
+    int think_ms;
+    int max_depth;
+    atomic_int stop;
+    struct timespec deadline;
+    int has_deadline;
+    int timed_out;
+    long long nodes;
+    MoveOrder order;
+    Ponder ponder;
+} Engine;
+
+// Function prototypes
+Engine* engine_create(int size, int num_players, size_t tt_mb);
+void engine_destroy(Engine *engine);
+void engine_new_game(Engine *engine);
+void position_init(Engine *engine, Position *pos);
+void position_from_game(Engine *engine, Position *pos, Game *game);
+int position_make(Engine *engine, Position *pos, int cell);
+void position_unmake(Engine *engine, Position *pos, int cell);
+int position_random_move(const Position *pos, Rng *rng);
+int engine_evaluate(Engine *engine, const Position *pos, int root);
+void engine_search(Engine *engine, const Position *pos, int root, int think_ms, SearchResult *result);
+int engine_should_stop(Engine *engine);
+int engine_stopped(Engine *engine);
+double elapsed_ms_since(const struct timespec *start);
+
+
+#endif
@@ -0,0 +1,137 @@
+#include "eval.h"
+
+
+//Hand-made weights: a line held by one player triples in value per piece
+
+void eval_default_weights(Engine *engine) {
+    memset(engine->weights, 0, sizeof(engine->weights));
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        int value = 1;
+        for (int c = 1; c <= engine->size; c++, value *= 3) {
+            for (int rel = 0; rel < engine->num_players; rel++) {
+                engine->weights[line][rel][c] = (int16_t)(rel == 0 ? value : -value);
+            }
+        }
+    }
+}
+
+
+//Default weights file for a board size and player count
+
+void eval_file_name(char *name, size_t len, int size, int num_players) {
+    snprintf(name, len, EVAL_FILE_FORMAT, size, size, num_players);
+}
+
+
+//FNV-1a over the weight bytes, stored at the end of the file
+
+static uint32_t checksum(const unsigned char *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+//Load learned weights, returns 0 (keeping the current weights) if the file is missing or invalid
+//Layout: "TTTE", version, size, players, a reserved byte that must be 0, then int16
+//little-endian weights for every line, relative player and piece count 1..size,
+//then a 32-bit checksum (8 + 2 * lines * players * size + 4 bytes, 172 for 4x4 2-player)
+
+int eval_load(Engine *engine, const char *path) {
+    unsigned char header[8];
+    unsigned char data[MAX_LINES * MAX_PLAYERS * MAX_SIZE * 2];
+    unsigned char tail[4];
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+
+    size_t len = (size_t)engine->num_lines * engine->num_players * engine->size * 2;
+    int ok = fread(header, 1, sizeof(header), file) == sizeof(header) &&
+             memcmp(header, EVAL_MAGIC, 4) == 0 && header[4] == EVAL_VERSION &&
+             header[5] == engine->size && header[6] == engine->num_players && header[7] == 0 &&
+             fread(data, 1, len, file) == len && fread(tail, 1, 4, file) == 4 &&
+             checksum(data, len) == ((uint32_t)tail[0] | (uint32_t)tail[1] << 8 |
+                                     (uint32_t)tail[2] << 16 | (uint32_t)tail[3] << 24);
+    fclose(file);
+
+    if (!ok) {
+        printf("Warning: '%s' is not a valid %dx%d, %d-player weights file.\n",
+               path, engine->size, engine->size, engine->num_players);
+        return 0;
+    }
+
+    const unsigned char *in = data;
+    memset(engine->weights, 0, sizeof(engine->weights));
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int rel = 0; rel < engine->num_players; rel++) {
+            for (int c = 1; c <= engine->size; c++, in += 2) {
+                engine->weights[line][rel][c] = (int16_t)(in[0] | in[1] << 8);
+            }
+        }
+    }
+
+    return 1;
+}
+
+
+//Write the engine's weights in the format read by eval_load
+
+int eval_save(const Engine *engine, const char *path) {
+    unsigned char header[8] = {'T', 'T', 'T', 'E', EVAL_VERSION,
+                               (unsigned char)engine->size, (unsigned char)engine->num_players, 0};
+    unsigned char data[MAX_LINES * MAX_PLAYERS * MAX_SIZE * 2];
+    unsigned char *out = data;
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int rel = 0; rel < engine->num_players; rel++) {
+            for (int c = 1; c <= engine->size; c++) {
+                uint16_t w = (uint16_t)engine->weights[line][rel][c];
+                *out++ = (unsigned char)(w & 0xFF);
+                *out++ = (unsigned char)(w >> 8);
+            }
+        }
+    }
+
+    size_t len = (size_t)(out - data);
+    uint32_t sum = checksum(data, len);
+    unsigned char tail[4] = {sum & 0xFF, (sum >> 8) & 0xFF, (sum >> 16) & 0xFF, sum >> 24};
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        printf("Could not write '%s'\n", path);
+        return 0;
+    }
+    int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+             fwrite(data, 1, len, file) == len && fwrite(tail, 1, 4, file) == 4;
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+
+//Evaluate from scratch (the incremental eval[] in Position must always match this)
+
+int eval_refresh(const Engine *engine, const Position *pos, int player) {
+    int np = pos->num_players;
+    int score = 0;
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        int owner = -1;
+
+        for (int p = 0; p < np; p++) {
+            if (pos->line_count[line][p]) {
+                owner = owner == -1 ? p : -2;
+            }
+        }
+
+        if (owner >= 0) {
+            score += engine->weights[line][(owner - player + np) % np][pos->line_count[line][owner]];
+        }
+    }
+
+    return score;
+}
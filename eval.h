@@ -0,0 +1,20 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "engine.h"
+
+// Constants
+#define EVAL_FILE_FORMAT "eval_%dx%d_%dp.bin"
+#define EVAL_MAGIC "TTTE"
+#define EVAL_VERSION 1
+#define EVAL_SCALE 400.0
+
+// Function prototypes
+void eval_default_weights(Engine *engine);
+void eval_file_name(char *name, size_t len, int size, int num_players);
+int eval_load(Engine *engine, const char *path);
+int eval_save(const Engine *engine, const char *path);
+int eval_refresh(const Engine *engine, const Position *pos, int player);
+
+
+#endif
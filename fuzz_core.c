@@ -0,0 +1,694 @@
+// Differential fuzz test and benchmark for the optimized game core
+//
+// Plays random and adversarial games on every board size with 2 and 3
+// players and checks each fast path against a plain reference that scans
+// the whole board, as checkWinCondition in game.c does:
+//   position_make/unmake   win flag, line counts, hash, incremental eval, undo
+//   check_win, check_draw  the Game rules of tictactoe.c
+//   eval_refresh           evaluation from the line counts
+//   batch_evaluate         status, winner and scores of the batch API
+//   solver_solve           exact value against brute-force minimax (3x3, 4x4)
+//   engine_search          takes an immediate win when there is one, and still
+//                          searches to some depth when the solver runs out of time
+//   snapshot_pack/unpack   round trip of the board and move history
+// Then times each fast path against its reference.
+//
+// Build: gcc -O2 -pthread fuzz_core.c tictactoe.c snapshot.c config.c ponder.c batch.c engine.c order.c
+//            eval.c solver.c tt.c rng.c stats.c -o fuzz_core
+// Usage: fuzz_core [--games N] [--seed S] [--size N] [--players P]
+// Exits with 1 and prints the game's moves at the first mismatch.
+
+#include "batch.h"
+#include "eval.h"
+#include "snapshot.h"
+#include "solver.h"
+
+#define FUZZ_BATCH 4096
+#define FUZZ_UNDO_DEPTH 6
+#define FUZZ_SOLVE_EMPTY 7
+#define FUZZ_TIMEOUT_MS 20
+#define BENCH_GAMES 2000
+
+// Move choice for a fuzzed game
+typedef enum {
+    MOVES_RANDOM,
+    MOVES_BUILDER,
+    MOVES_SPOILER,
+    MOVES_KINDS
+} MoveKind;
+
+// Reference board, cells hold player index + 1 and 0 for empty
+typedef struct {
+    int size;
+    int num_players;
+    unsigned char cells[MAX_CELLS];
+} RefBoard;
+
+// Game being checked, printed on a mismatch
+typedef struct {
+    uint64_t seed;
+    int game;
+    MoveKind kind;
+    int random_weights;
+    int moves[MAX_CELLS];
+    int num_moves;
+} Trace;
+
+// Settings
+typedef struct {
+    int games;
+    uint64_t seed;
+    int size;
+    int num_players;
+} Options;
+
+static Trace trace;
+static long long checks;
+
+
+//Report a mismatch with everything needed to replay it, then stop
+
+static void fail(const RefBoard *board, const char *what) {
+    printf("\nMISMATCH: %s\n", what);
+    printf("Board %dx%d, %d players, seed %llu, game %d, %s moves%s\n",
+           board->size, board->size, board->num_players, (unsigned long long)trace.seed, trace.game,
+           trace.kind == MOVES_RANDOM ? "random" : (trace.kind == MOVES_BUILDER ? "builder" : "spoiler"),
+           trace.random_weights ? ", random weights" : "");
+    printf("Moves:");
+    for (int i = 0; i < trace.num_moves; i++) {
+        printf(" %d,%d", trace.moves[i] / board->size + 1, trace.moves[i] % board->size + 1);
+    }
+    printf("\n");
+    for (int row = 0; row < board->size; row++) {
+        for (int col = 0; col < board->size; col++) {
+            printf(" %c", ".XOZ"[board->cells[row * board->size + col]]);
+        }
+        printf("\n");
+    }
+    exit(1);
+}
+
+static void check(int ok, const RefBoard *board, const char *what) {
+    checks++;
+    if (!ok) {
+        fail(board, what);
+    }
+}
+
+
+//Reference line enumeration in the engine's order: rows, columns, main
+//diagonal, anti-diagonal; returns the cell k of a line
+
+static int ref_line_cell(int size, int line, int k) {
+    if (line < size) return line * size + k;
+    if (line < 2 * size) return k * size + (line - size);
+    if (line == 2 * size) return k * size + k;
+    return k * size + (size - 1 - k);
+}
+
+static int ref_line_count(const RefBoard *board, int line, int p) {
+    int count = 0;
+    for (int k = 0; k < board->size; k++) {
+        count += board->cells[ref_line_cell(board->size, line, k)] == p + 1;
+    }
+    return count;
+}
+
+
+//Every player with a complete line anywhere on the board, as a bit mask
+
+static int ref_winners(const RefBoard *board) {
+    int winners = 0;
+    for (int line = 0; line < 2 * board->size + 2; line++) {
+        for (int p = 0; p < board->num_players; p++) {
+            if (ref_line_count(board, line, p) == board->size) {
+                winners |= 1 << p;
+            }
+        }
+    }
+    return winners;
+}
+
+
+//Does a line through cell belong entirely to player p
+
+static int ref_wins_through(const RefBoard *board, int cell, int p) {
+    int size = board->size, row = cell / size, col = cell % size;
+
+    return ref_line_count(board, row, p) == size ||
+           ref_line_count(board, size + col, p) == size ||
+           (row == col && ref_line_count(board, 2 * size, p) == size) ||
+           (row + col == size - 1 && ref_line_count(board, 2 * size + 1, p) == size);
+}
+
+
+//Evaluation for player q straight from the cells
+
+static int ref_eval(const Engine *engine, const RefBoard *board, int q) {
+    int np = board->num_players;
+    int score = 0;
+
+    for (int line = 0; line < 2 * board->size + 2; line++) {
+        int owner = -1, count = 0;
+        for (int p = 0; p < np; p++) {
+            int c = ref_line_count(board, line, p);
+            if (c) {
+                owner = owner == -1 ? p : -2;
+                count = c;
+            }
+        }
+        if (owner >= 0) {
+            score += engine->weights[line][(owner - q + np) % np][count];
+        }
+    }
+
+    return score;
+}
+
+static uint64_t ref_hash(const Engine *engine, const RefBoard *board, int to_move) {
+    uint64_t hash = engine->zobrist_side[to_move];
+    for (int cell = 0; cell < board->size * board->size; cell++) {
+        if (board->cells[cell]) {
+            hash ^= engine->zobrist[cell][board->cells[cell] - 1];
+        }
+    }
+    return hash;
+}
+
+
+//Brute-force value for root (1 win, 0 draw, -1 loss), everyone else against it
+
+static int ref_solve(RefBoard *board, int to_move, int root) {
+    int best = to_move == root ? -2 : 2;
+    int empty = 0;
+
+    for (int cell = 0; cell < board->size * board->size; cell++) {
+        if (board->cells[cell]) {
+            continue;
+        }
+        empty++;
+
+        board->cells[cell] = (unsigned char)(to_move + 1);
+        int value = ref_wins_through(board, cell, to_move) ? (to_move == root ? 1 : -1)
+                                                            : ref_solve(board, (to_move + 1) % board->num_players, root);
+        board->cells[cell] = 0;
+
+        if (to_move == root ? value > best : value < best) {
+            best = value;
+        }
+    }
+
+    return empty ? best : 0;
+}
+
+
+//The incrementally kept position must match one rebuilt from the cells
+
+static void check_position(const Engine *engine, const Position *pos, const RefBoard *board, int to_move) {
+    int empty = 0;
+    for (int cell = 0; cell < board->size * board->size; cell++) {
+        empty += !board->cells[cell];
+    }
+
+    check(memcmp(pos->cells, board->cells, board->size * board->size) == 0, board, "cells");
+    check(pos->empty == empty && pos->to_move == to_move, board, "empty count or side to move");
+    check(pos->hash == ref_hash(engine, board, to_move), board, "hash");
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int p = 0; p < board->num_players; p++) {
+            check(pos->line_count[line][p] == ref_line_count(board, line, p), board, "line count");
+        }
+    }
+    for (int q = 0; q < board->num_players; q++) {
+        int expected = ref_eval(engine, board, q);
+        check(pos->eval[q] == expected, board, "incremental eval");
+        check(eval_refresh(engine, pos, q) == expected, board, "eval_refresh");
+    }
+}
+
+static int same_position(const Position *a, const Position *b) {
+    return memcmp(a->cells, b->cells, sizeof(a->cells)) == 0 &&
+           memcmp(a->line_count, b->line_count, sizeof(a->line_count)) == 0 &&
+           memcmp(a->eval, b->eval, sizeof(a->eval)) == 0 &&
+           a->empty == b->empty && a->to_move == b->to_move && a->hash == b->hash;
+}
+
+
+//Pick a move: random, building the mover's fullest lines, or playing into
+//lines other players already share
+
+static int choose_move(const RefBoard *board, int to_move, MoveKind kind, Rng *rng) {
+    int best[MAX_CELLS], num_best = 0, best_score = -1;
+
+    for (int cell = 0; cell < board->size * board->size; cell++) {
+        if (board->cells[cell]) {
+            continue;
+        }
+
+        int score = 0;
+        if (kind != MOVES_RANDOM) {
+            for (int line = 0; line < 2 * board->size + 2; line++) {
+                int on_line = 0;
+                for (int k = 0; k < board->size; k++) {
+                    on_line |= ref_line_cell(board->size, line, k) == cell;
+                }
+                if (!on_line) continue;
+
+                int owners = 0, own = ref_line_count(board, line, to_move);
+                for (int p = 0; p < board->num_players; p++) {
+                    owners += ref_line_count(board, line, p) > 0;
+                }
+                score += kind == MOVES_BUILDER ? (owners == (own > 0) ? own * own : 0) : owners;
+            }
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            num_best = 0;
+        }
+        if (score == best_score) {
+            best[num_best++] = cell;
+        }
+    }
+
+    return best[rng_below(rng, (uint32_t)num_best)];
+}
+
+
+//Game structure of tictactoe.c around a reference board, without a log or engine
+
+static Game* make_game(int size, int num_players) {
+    Game *game = (Game*)calloc(1, sizeof(Game));
+    if (!game) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    game->size = size;
+    game->num_players = num_players;
+    game->board = (char**)malloc(size * sizeof(char*));
+    for (int i = 0; i < size; i++) {
+        game->board[i] = (char*)malloc(size);
+        memset(game->board[i], ' ', size);
+    }
+    for (int p = 0; p < num_players; p++) {
+        game->players[p].symbol = "XOZ"[p];
+        sprintf(game->players[p].name, "P%d", p + 1);
+    }
+    return game;
+}
+
+static void free_game(Game *game) {
+    for (int i = 0; i < game->size; i++) {
+        free(game->board[i]);
+    }
+    free(game->board);
+    free(game);
+}
+
+
+//Compare the batch results with the reference boards pushed into it
+
+static void check_batch(const Engine *engine, PositionBatch *batch, const RefBoard *boards) {
+    batch_evaluate(engine, batch, 2);
+
+    for (int i = 0; i < batch->count; i++) {
+        const RefBoard *board = &boards[i];
+        int winners = ref_winners(board), full = 1;
+        for (int cell = 0; cell < board->size * board->size; cell++) {
+            full &= board->cells[cell] != 0;
+        }
+
+        int status = winners ? BATCH_WIN : (full ? BATCH_DRAW : BATCH_ONGOING);
+        check(batch->status[i] == status, board, "batch status");
+        check(!winners || (winners >> batch->winner[i] & 1), board, "batch winner");
+        for (int q = 0; q < board->num_players; q++) {
+            check(batch->score[q][i] == ref_eval(engine, board, q), board, "batch score");
+        }
+    }
+
+    batch_clear(batch);
+}
+
+
+//Exact solver and the search against brute force on a small position
+
+static void check_search(Engine *engine, const Position *pos, RefBoard *board) {
+    SearchResult result;
+    int root = pos->to_move;
+
+    engine->has_deadline = 0;
+    engine->timed_out = 0;
+    check(solver_solve(engine, pos, root, &result), board, "solver gave up");
+
+    int value = result.score > 0 ? 1 : (result.score < 0 ? -1 : 0);
+    check(value == ref_solve(board, root, root), board, "solver value");
+
+    board->cells[result.move] = (unsigned char)(root + 1);
+    int move_value = ref_wins_through(board, result.move, root) ? 1
+                                                                : ref_solve(board, (root + 1) % board->num_players, root);
+    board->cells[result.move] = 0;
+    check(move_value == value, board, "solver move");
+}
+
+static void check_immediate_win(Engine *engine, const Position *pos, RefBoard *board) {
+    int root = pos->to_move, winning = -1;
+
+    for (int cell = 0; cell < board->size * board->size && winning < 0; cell++) {
+        if (!board->cells[cell]) {
+            board->cells[cell] = (unsigned char)(root + 1);
+            if (ref_wins_through(board, cell, root)) winning = cell;
+            board->cells[cell] = 0;
+        }
+    }
+    if (winning < 0) {
+        return;
+    }
+
+    SearchResult result;
+    engine->max_depth = 2;
+    engine_search(engine, pos, root, -1, &result);
+
+    board->cells[result.move] = (unsigned char)(root + 1);
+    int wins = ref_wins_through(board, result.move, root);
+    board->cells[result.move] = 0;
+    check(wins && result.score == WIN_SCORE - 1, board, "search missed an immediate win");
+}
+
+
+//A solver that runs out of time hands the rest of the budget to the
+//depth-limited search, which must finish at least one iteration
+
+static void check_solver_timeout(Engine *engine, Rng *rng) {
+    RefBoard board = {engine->size, engine->num_players, {0}};
+    Position pos;
+
+    // Random half-full board without a winner (the failure report shows the board)
+    trace.num_moves = 0;
+    do {
+        position_init(engine, &pos);
+        while (pos.empty > engine->size * engine->size / 2) {
+            if (position_make(engine, &pos, position_random_move(&pos, rng))) {
+                break;
+            }
+        }
+    } while (pos.empty > engine->size * engine->size / 2);
+    for (int cell = 0; cell < engine->size * engine->size; cell++) {
+        board.cells[cell] = pos.cells[cell];
+    }
+
+    SearchResult result;
+    engine->solve_empty = MAX_CELLS;
+    engine->max_depth = 0;
+    tt_clear(&engine->solved);
+    engine_search(engine, &pos, pos.to_move, FUZZ_TIMEOUT_MS, &result);
+    engine->solve_empty = 0;
+
+    check(result.depth > 0 && result.move >= 0 && !pos.cells[result.move], &board,
+          "search after a solver timeout");
+}
+
+
+//One fuzzed game: every move is checked, with undo runs along the way
+
+static void fuzz_game(Engine *engine, Game *game, PositionBatch *batch, RefBoard *batch_boards, Rng *rng) {
+    static Position history[MAX_PLY + 1];
+    int size = engine->size, np = engine->num_players;
+    RefBoard board = {size, np, {0}};
+    Position pos;
+    int first_win = 0;
+
+    position_init(engine, &pos);
+    history[0] = pos;
+    for (int i = 0; i < size; i++) {
+        memset(game->board[i], ' ', size);
+    }
+    game->num_moves = 0;
+    game->current_player = 0;
+
+    for (int ply = 0; pos.empty > 0; ply++) {
+        int mover = pos.to_move;
+        int cell = choose_move(&board, mover, trace.kind, rng);
+        int row = cell / size, col = cell % size;
+
+        trace.moves[trace.num_moves++] = cell;
+        board.cells[cell] = (unsigned char)(mover + 1);
+        int won = position_make(engine, &pos, cell);
+        history[ply + 1] = pos;
+
+        // Engine and tictactoe.c rules against the full-board reference
+        int through = ref_wins_through(&board, cell, mover);
+        check(won == through, &board, "position_make win flag");
+        check_position(engine, &pos, &board, (mover + 1) % np);
+
+        game->current_player = mover;
+        game->board[row][col] = "XOZ"[mover];
+        game->moves[game->num_moves++] = (unsigned char)cell;
+        check(check_win(game, row, col) == through, &board, "check_win");
+        if (!first_win) {
+            check(check_win(game, row, col) == (ref_winners(&board) == 1 << mover), &board,
+                  "check_win against the full-board scan");
+        }
+        check(check_draw(game) == (pos.empty == 0), &board, "check_draw");
+
+        // Batch the positions with at most one winner
+        if (!first_win || ref_winners(&board) == 1 << mover) {
+            batch_boards[batch->count] = board;
+            batch_push(batch, &pos);
+            if (batch->count == FUZZ_BATCH) {
+                check_batch(engine, batch, batch_boards);
+            }
+        }
+
+        if (!first_win && size <= 4 && pos.empty == FUZZ_SOLVE_EMPTY) {
+            check_search(engine, &pos, &board);
+        }
+        if (!first_win && !won && pos.empty > 0 && rng_below(rng, 4) == 0) {
+            check_immediate_win(engine, &pos, &board);
+        }
+        first_win |= won;
+
+        // Take back a few moves, then replay them
+        if (rng_below(rng, 8) == 0) {
+            int undo = 1 + (int)rng_below(rng, (uint32_t)(ply + 1 < FUZZ_UNDO_DEPTH ? ply + 1 : FUZZ_UNDO_DEPTH));
+            for (int k = 0; k < undo; k++) {
+                position_unmake(engine, &pos, trace.moves[trace.num_moves - 1 - k]);
+                check(same_position(&pos, &history[ply - k]), &board, "position_unmake");
+            }
+            for (int k = undo - 1; k >= 0; k--) {
+                position_make(engine, &pos, trace.moves[trace.num_moves - 1 - k]);
+                check(same_position(&pos, &history[ply + 1 - k]), &board, "make after unmake");
+            }
+        }
+    }
+
+    // Snapshot round trip of the finished board
+    unsigned char buf[SNAPSHOT_MAX_BYTES];
+    size_t len = snapshot_pack(game, buf, sizeof(buf));
+    Game *copy = make_game(size, np);
+    check(len > 0 && snapshot_unpack(copy, buf, len) && copy->num_moves == game->num_moves, &board, "snapshot");
+    for (int i = 0; i < size; i++) {
+        check(memcmp(copy->board[i], game->board[i], size) == 0, &board, "snapshot board");
+    }
+    free_game(copy);
+}
+
+
+//Random weights, so the evaluation checks do not depend on the built-in table
+
+static void randomize_weights(Engine *engine, Rng *rng) {
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int rel = 0; rel < engine->num_players; rel++) {
+            engine->weights[line][rel][0] = 0;
+            for (int c = 1; c <= engine->size; c++) {
+                engine->weights[line][rel][c] = (int16_t)((int)rng_below(rng, 2001) - 1000);
+            }
+        }
+    }
+}
+
+
+//Time each fast path against its reference on the same random games
+
+static void benchmark(Engine *engine, Rng *rng) {
+    int size = engine->size, np = engine->num_players, cells = size * size;
+    static int games[BENCH_GAMES][MAX_CELLS];
+    Game *game = make_game(size, np);
+    RefBoard board = {size, np, {0}};
+    struct timespec started;
+    volatile long long sink = 0;
+    double fast_win, ref_win, fast_rules, fast_eval, ref_eval_ms;
+
+    for (int g = 0; g < BENCH_GAMES; g++) {
+        Position pos;
+        position_init(engine, &pos);
+        for (int ply = 0; ply < cells; ply++) {
+            games[g][ply] = position_random_move(&pos, rng);
+            position_make(engine, &pos, games[g][ply]);
+        }
+    }
+
+    // Win detection: make/unmake against a full-board scan after every move
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int g = 0; g < BENCH_GAMES; g++) {
+        Position pos;
+        position_init(engine, &pos);
+        for (int ply = 0; ply < cells; ply++) sink += position_make(engine, &pos, games[g][ply]);
+        for (int ply = cells - 1; ply >= 0; ply--) position_unmake(engine, &pos, games[g][ply]);
+    }
+    fast_win = elapsed_ms_since(&started);
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int g = 0; g < BENCH_GAMES; g++) {
+        memset(board.cells, 0, sizeof(board.cells));
+        for (int ply = 0; ply < cells; ply++) {
+            board.cells[games[g][ply]] = (unsigned char)(ply % np + 1);
+            sink += ref_winners(&board);
+        }
+    }
+    ref_win = elapsed_ms_since(&started);
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int g = 0; g < BENCH_GAMES; g++) {
+        for (int i = 0; i < size; i++) memset(game->board[i], ' ', size);
+        for (int ply = 0; ply < cells; ply++) {
+            int cell = games[g][ply];
+            game->current_player = ply % np;
+            game->board[cell / size][cell % size] = "XOZ"[ply % np];
+            sink += check_win(game, cell / size, cell % size);
+        }
+    }
+    fast_rules = elapsed_ms_since(&started);
+
+    // Evaluation: rebuilt from line counts against rebuilt from cells
+    Position pos;
+    position_init(engine, &pos);
+    memset(board.cells, 0, sizeof(board.cells));
+    for (int ply = 0; ply < cells / 2; ply++) {
+        position_make(engine, &pos, games[0][ply]);
+        board.cells[games[0][ply]] = (unsigned char)(ply % np + 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int i = 0; i < BENCH_GAMES * 10; i++) sink += eval_refresh(engine, &pos, i % np);
+    fast_eval = elapsed_ms_since(&started);
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (int i = 0; i < BENCH_GAMES * 10; i++) sink += ref_eval(engine, &board, i % np);
+    ref_eval_ms = elapsed_ms_since(&started);
+
+    double moves = (double)BENCH_GAMES * cells;
+    printf("%2dx%-3d %-8d %12.1f %12.1f %12.1f %12.1f %12.1f\n", size, size, np,
+           fast_win * 1e6 / (2 * moves), fast_rules * 1e6 / moves, ref_win * 1e6 / moves,
+           fast_eval * 1e6 / (BENCH_GAMES * 10), ref_eval_ms * 1e6 / (BENCH_GAMES * 10));
+    free_game(game);
+}
+
+
+//Read the command line
+
+static int parse_args(Options *opt, int argc, char **argv) {
+    opt->games = 200;
+    opt->seed = rng_time_seed();
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i], *value = argv[i + 1];
+
+        if (strcmp(arg, "--games") == 0) opt->games = atoi(value);
+        else if (strcmp(arg, "--seed") == 0) opt->seed = strtoull(value, NULL, 10);
+        else if (strcmp(arg, "--size") == 0) opt->size = atoi(value);
+        else if (strcmp(arg, "--players") == 0) opt->num_players = atoi(value);
+        else {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+    }
+
+    if (argc % 2 == 0 || opt->games < 1 || (opt->size && (opt->size < MIN_SIZE || opt->size > MAX_SIZE)) ||
+        (opt->num_players && (opt->num_players < 2 || opt->num_players > MAX_PLAYERS))) {
+        printf("Usage: fuzz_core [--games N] [--seed S] [--size %d-%d] [--players 2-%d]\n",
+               MIN_SIZE, MAX_SIZE, MAX_PLAYERS);
+        return 0;
+    }
+    return 1;
+}
+
+
+int main(int argc, char **argv) {
+    static RefBoard batch_boards[FUZZ_BATCH];
+    Options opt = {0};
+
+    if (!parse_args(&opt, argc, argv)) {
+        return 1;
+    }
+    trace.seed = opt.seed;
+
+    printf("Fuzzing %d games per board and player count, seed %llu\n",
+           opt.games, (unsigned long long)opt.seed);
+    printf("%-6s %-8s %10s %10s\n", "Board", "Players", "Games", "Checks");
+
+    for (int np = 2; np <= MAX_PLAYERS; np++) {
+        for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+            if ((opt.size && size != opt.size) || (opt.num_players && np != opt.num_players)) {
+                continue;
+            }
+
+            Engine *engine = engine_create(size, np, 1);
+            PositionBatch *batch = batch_create(size, np, FUZZ_BATCH);
+            Game *game = make_game(size, np);
+            long long before = checks;
+            Rng rng;
+
+            if (!engine || !batch) {
+                return 1;
+            }
+            engine->solve_empty = 0;
+
+            for (int g = 0; g < opt.games; g++) {
+                // Every game has its own stream, so a failure replays from the game number
+                rng_seed(&rng, opt.seed, (uint64_t)(g * 16 + size) * 4 + np);
+                trace.game = g;
+                trace.kind = (MoveKind)(g % MOVES_KINDS);
+                trace.random_weights = g % 2;
+                trace.num_moves = 0;
+
+                if (trace.random_weights) {
+                    randomize_weights(engine, &rng);
+                } else {
+                    eval_default_weights(engine);
+                }
+                if (batch->count) {
+                    check_batch(engine, batch, batch_boards);
+                }
+                fuzz_game(engine, game, batch, batch_boards, &rng);
+            }
+            check_batch(engine, batch, batch_boards);
+            check_solver_timeout(engine, &rng);
+
+            printf("%2dx%-3d %-8d %10d %10lld\n", size, size, np, opt.games, checks - before);
+            free_game(game);
+            batch_destroy(batch);
+            engine_destroy(engine);
+        }
+    }
+    printf("All %lld checks passed\n\n", checks);
+
+    printf("Nanoseconds per call:\n");
+    printf("%-6s %-8s %12s %12s %12s %12s %12s\n", "Board", "Players", "make/unmake", "check_win",
+           "full scan", "eval_refresh", "eval cells");
+    for (int np = 2; np <= MAX_PLAYERS; np++) {
+        for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+            if ((opt.size && size != opt.size) || (opt.num_players && np != opt.num_players)) {
+                continue;
+            }
+            Engine *engine = engine_create(size, np, 0);
+            Rng rng;
+            if (!engine) {
+                return 1;
+            }
+            rng_seed(&rng, opt.seed, 0);
+            benchmark(engine, &rng);
+            engine_destroy(engine);
+        }
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include "rng.h"
+#include "config.h"
 
 
 #define MAX_GRID_SIZE 10
@@ -25,10 +27,13 @@ typedef struct {
     int current_player;
     int moves_made;
     FILE *log_file;
+    const char *log_path;
+    uint64_t seed;
+    Rng rng;
 } Game;
 
 // Function prototypes
-Game* initializeGame(int size, int num_players);
+Game* initializeGame(int size, int num_players, uint64_t seed, const char *log_path);
 void destroyGame(Game *game);
 void displayBoard(Game *game);
 int validateInput(Game *game, int row, int col);
@@ -39,11 +44,11 @@ void getUserInput(Game *game, int *row, int *col);
 void generateComputerMove(Game *game, int *row, int *col);
 void logMove(Game *game, int row, int col);
 void playGame(Game *game);
-void setupPlayers(Game *game);
+void setupPlayers(Game *game, const Config *config);
 void displayGameStatus(Game *game);
 
-// Initialize the game board and structures
-Game* initializeGame(int size, int num_players) {
+// Initialize the game board and structures (no log_path disables the log)
+Game* initializeGame(int size, int num_players, uint64_t seed, const char *log_path) {
     Game *game = (Game*)malloc(sizeof(Game));
     if (!game) {
         printf("Memory allocation failed!\n");
@@ -55,6 +60,10 @@ Game* initializeGame(int size, int num_players) {
     game->current_player = 0;
     game->moves_made = 0;
 
+    // Private random stream, the game can be replayed from its seed
+    game->seed = seed;
+    rng_seed(&game->rng, seed, 0);
+
     // Allocate memory for board
     game->board = (char**)malloc(size * sizeof(char*));
     for (int i = 0; i < size; i++) {
@@ -70,11 +79,13 @@ Game* initializeGame(int size, int num_players) {
     game->symbols[2] = 'Z';
 
     // Open log file
-    game->log_file = fopen(LOG_FILE, "w");
+    game->log_path = log_path;
+    game->log_file = log_path ? fopen(log_path, "w") : NULL;
     if (game->log_file) {
         fprintf(game->log_file, "=== TIC-TAC-TOE GAME LOG ===\n");
         fprintf(game->log_file, "Grid Size: %dx%d\n", size, size);
-        fprintf(game->log_file, "Number of Players: %d\n\n", num_players);
+        fprintf(game->log_file, "Number of Players: %d\n", num_players);
+        fprintf(game->log_file, "Seed: %llu\n\n", (unsigned long long)seed);
         fflush(game->log_file);
     }
 
@@ -239,27 +250,17 @@ void getUserInput(Game *game, int *row, int *col) {
 
 // Generate random move for computer player
 void generateComputerMove(Game *game, int *row, int *col) {
-    int attempts = 0;
-    const int max_attempts = 1000;
-
-    do {
-        *row = rand() % game->size;
-        *col = rand() % game->size;
-        attempts++;
-
-        if (attempts > max_attempts) {
-            // Fallback: find first available position
-            for (int i = 0; i < game->size; i++) {
-                for (int j = 0; j < game->size; j++) {
-                    if (game->board[i][j] == ' ') {
-                        *row = i;
-                        *col = j;
-                        return;
-                    }
-                }
+    // Pick one of the empty cells uniformly
+    int pick = (int)rng_below(&game->rng, (uint32_t)(game->size * game->size - game->moves_made));
+
+    for (int i = 0; i < game->size && pick >= 0; i++) {
+        for (int j = 0; j < game->size && pick >= 0; j++) {
+            if (game->board[i][j] == ' ' && pick-- == 0) {
+                *row = i;
+                *col = j;
             }
         }
-    } while (game->board[*row][*col] != ' ');
+    }
 
     printf("Computer Player %d (%c) chooses position: %d %d\n",
            game->current_player + 1, game->symbols[game->current_player],
@@ -286,11 +287,20 @@ void logMove(Game *game, int row, int col) {
     }
 }
 
-// Setup player types for the game
-void setupPlayers(Game *game) {
-    printf("\n=== PLAYER SETUP ===\n");
+// Setup player types for the game, asking only for seats that were not configured
+// (computer players here always play random moves)
+void setupPlayers(Game *game, const Config *config) {
+    int asked = 0;
 
     for (int i = 0; i < game->num_players; i++) {
+        if (config->seats[i].type != SEAT_UNSET) {
+            game->player_types[i] = config->seats[i].type == SEAT_HUMAN ? HUMAN_PLAYER : COMPUTER_PLAYER;
+            continue;
+        }
+
+        if (!asked++) {
+            printf("\n=== PLAYER SETUP ===\n");
+        }
         printf("Player %d (%c) - Choose type:\n", i + 1, game->symbols[i]);
         printf("1. Human Player\n");
         printf("2. Computer Player\n");
@@ -307,7 +317,10 @@ void setupPlayers(Game *game) {
                (choice == 1) ? "Human" : "Computer");
     }
 
-    // Ensure at least one human player
+    // Ensure at least one human player, unless every seat was configured
+    if (!asked) {
+        return;
+    }
     int human_count = 0;
     for (int i = 0; i < game->num_players; i++) {
         if (game->player_types[i] == HUMAN_PLAYER) {
@@ -382,21 +395,35 @@ void playGame(Game *game) {
         }
     }
 
-    printf("\nGame log has been saved to '%s'\n", LOG_FILE);
+    if (game->log_path) {
+        printf("\nGame log has been saved to '%s'\n", game->log_path);
+    }
 }
 
-// Main function with menu system
-int main() {
-    srand(time(NULL)); // Seed random number generator
+// Main function with menu system, anything given on the command line is not asked for
+int main(int argc, char **argv) {
+    Config config;
+
+    config_defaults(&config, LOG_FILE);
+    if (!config_parse_args(&config, argc, argv)) {
+        return 1;
+    }
+    if (config.size && (config.size < MIN_GRID_SIZE || config.size > MAX_GRID_SIZE)) {
+        printf("Grid size must be between %d and %d!\n", MIN_GRID_SIZE, MAX_GRID_SIZE);
+        return 1;
+    }
+
+    // Seed for this game's random stream
+    uint64_t seed = config.has_seed ? config.seed : rng_time_seed();
 
     printf("=============================\n");
     printf("     TIC-TAC-TOE GAME   \n");
     printf("=============================\n");
 
-    int size, num_players;
+    int size = config.size, num_players = config.num_players;
 
     // Get grid size
-    do {
+    while (size < MIN_GRID_SIZE || size > MAX_GRID_SIZE) {
         printf("\nEnter grid size (%d-%d): ", MIN_GRID_SIZE, MAX_GRID_SIZE);
         if (scanf("%d", &size) != 1) {
             printf("Invalid input! Please enter a number.\n");
@@ -407,10 +434,10 @@ int main() {
         if (size < MIN_GRID_SIZE || size > MAX_GRID_SIZE) {
             printf("Grid size must be between %d and %d!\n", MIN_GRID_SIZE, MAX_GRID_SIZE);
         }
-    } while (size < MIN_GRID_SIZE || size > MAX_GRID_SIZE);
+    }
 
     // Get number of players
-    do {
+    while (num_players < 2 || num_players > MAX_PLAYERS) {
         printf("Enter number of players (2-3): ");
         if (scanf("%d", &num_players) != 1) {
             printf("Invalid input! Please enter a number.\n");
@@ -421,17 +448,17 @@ int main() {
         if (num_players < 2 || num_players > MAX_PLAYERS) {
             printf("Number of players must be 2 or 3!\n");
         }
-    } while (num_players < 2 || num_players > MAX_PLAYERS);
+    }
 
     // Initialize game
-    Game *game = initializeGame(size, num_players);
+    Game *game = initializeGame(size, num_players, seed, config.log_enabled ? config.log_path : NULL);
     if (!game) {
         printf("Failed to initialize game!\n");
         return 1;
     }
 
     // Setup players
-    setupPlayers(game);
+    setupPlayers(game, &config);
 
     // Play the game
     playGame(game);
@@ -1,84 +1,167 @@
 #include "tictactoe.h"
+#include "snapshot.h"
+#include "stats.h"
 
-int main() {
-    srand(time(NULL)); // Seed for random number generation
+// Master random stream, each game draws its own seed from it
+static Rng master_rng;
+static int master_seeded = 0;
 
-    int size, num_players, mode;
-    Game *game = NULL;
+// Settings from the command line, read once
+static Config config;
 
-    printf("=== Tic-Tac-Toe ===\n\n");
+int main(int argc, char **argv) {
+    uint64_t seed;
 
-    // Get board size
-    do {
-        printf("Enter board size (%d-%d): ", MIN_SIZE, MAX_SIZE);
-        if (scanf("%d", &size) != 1 || size < MIN_SIZE || size > MAX_SIZE) {
+    if (!master_seeded) {
+        config_defaults(&config, LOG_FILE);
+        if (!config_parse_args(&config, argc, argv)) {
+            return 1;
+        }
+        if (config.size && (config.size < MIN_SIZE || config.size > MAX_SIZE)) {
             printf("Invalid size! Please enter a number between %d and %d.\n", MIN_SIZE, MAX_SIZE);
-            // Clear invalid input
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
-            continue;
+            return 1;
         }
-        break;
-    } while (1);
-
-    // Get game mode
-    printf("\nSelect game mode:\n");
-    printf("1. Two Player (Human vs Human)\n");
-    printf("2. User vs Computer\n");
-    printf("3. Multi-Player (3 players)\n");
-    printf("Enter choice (1-3): ");
-
-    do {
-        if (scanf("%d", &mode) != 1 || mode < 1 || mode > 3) {
-            printf("Invalid choice! Please enter 1, 2, or 3: ");
-            // Clear invalid input
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
-            continue;
+
+        // Metrics are exported here only, the tools sharing the game code write none
+        if (config.stats_enabled) {
+            STATS_EXPORT(config.stats_path[0] ? config.stats_path : STATS_FILE);
         }
-        break;
-    } while (1);
-
-    // Set number of players based on mode
-    switch (mode) {
-        case 1:
-        case 2:
-            num_players = 2;
-            break;
-        case 3:
-            num_players = 3;
-            break;
-        default:
-            printf("Invalid mode selected!\n");
-            return 1;
+
+        // A given seed is used for the first game as is
+        rng_seed(&master_rng, config.has_seed ? config.seed : rng_time_seed(), 0);
+        seed = config.has_seed ? config.seed : rng_next(&master_rng);
+        master_seeded = 1;
+    } else {
+        seed = rng_next(&master_rng);
     }
 
-    // Initialize game
-    game = initialize_game(size, num_players);
-    if (!game) {
-        printf("Failed to initialize game!\n");
-        return 1;
+    int size = config.size, num_players = config.num_players, mode;
+    int interactive = !config_complete(&config);
+    const char *log_path = config.log_enabled ? config.log_path : NULL;
+    Config setup = config;
+    Game *game = NULL;
+
+    // Snapshots are kept where configured, by default only for interactive
+    // launches (fully configured ones are often run side by side from scripts)
+    const char *snapshot_path = NULL;
+    if (config.snapshot_enabled > 0) {
+        snapshot_path = config.snapshot_path;
+    } else if (config.snapshot_enabled < 0 && interactive) {
+        snapshot_path = SNAPSHOT_FILE;
     }
 
-    // Setup players
-    setup_players(game);
+    printf("=== Tic-Tac-Toe ===\n\n");
+
+    // Offer to resume a game that was interrupted
+    if (interactive && snapshot_path && snapshot_info(snapshot_path, &size, &num_players)) {
+        char resume;
+        printf("Found an unfinished %dx%d game with %d players. Resume it? (y/n): ", size, size, num_players);
+        scanf(" %c", &resume);
+
+        if (resume == 'y' || resume == 'Y') {
+            game = snapshot_load(snapshot_path, log_path);
+        } else {
+            remove(snapshot_path);
+        }
+    }
+
+    if (!game) {
+        size = config.size;
+        num_players = config.num_players;
+
+        // Get board size
+        while (!size) {
+            printf("Enter board size (%d-%d): ", MIN_SIZE, MAX_SIZE);
+            if (scanf("%d", &size) != 1 || size < MIN_SIZE || size > MAX_SIZE) {
+                printf("Invalid size! Please enter a number between %d and %d.\n", MIN_SIZE, MAX_SIZE);
+                // Clear invalid input
+                int c;
+                while ((c = getchar()) != '\n' && c != EOF);
+                size = 0;
+                continue;
+            }
+        }
+
+        // Get game mode, which also fixes the seats that were not configured
+        if (!num_players) {
+            printf("\nSelect game mode:\n");
+            printf("1. Two Player (Human vs Human)\n");
+            printf("2. User vs Computer\n");
+            printf("3. Multi-Player (3 players)\n");
+            printf("Enter choice (1-3): ");
+
+            do {
+                if (scanf("%d", &mode) != 1 || mode < 1 || mode > 3) {
+                    printf("Invalid choice! Please enter 1, 2, or 3: ");
+                    // Clear invalid input
+                    int c;
+                    while ((c = getchar()) != '\n' && c != EOF);
+                    continue;
+                }
+                break;
+            } while (1);
+
+            // Set number of players and seats based on mode
+            switch (mode) {
+                case 1:
+                case 2:
+                    num_players = 2;
+                    break;
+                case 3:
+                    num_players = 3;
+                    break;
+                default:
+                    printf("Invalid mode selected!\n");
+                    return 1;
+            }
+
+            // Player 1 is always human; player 2 is what the menu says, a human in
+            // mode 1 and the computer in mode 2 (the original code put the computer
+            // in seat 2 of every two player game, so mode 1 was mode 2 under
+            // another name)
+            if (setup.seats[0].type == SEAT_UNSET) {
+                setup.seats[0].type = SEAT_HUMAN;
+            }
+            if (mode < 3 && setup.seats[1].type == SEAT_UNSET) {
+                setup.seats[1].type = mode == 1 ? SEAT_HUMAN : SEAT_COMPUTER;
+            }
+        }
+
+        // Initialize game
+        game = initialize_game(size, num_players, seed, log_path);
+        if (!game) {
+            printf("Failed to initialize game!\n");
+            return 1;
+        }
+
+        // Setup players
+        setup_players(game, &setup);
+    }
 
     // Play the game
+    if (snapshot_path) {
+        snprintf(game->snapshot_path, sizeof(game->snapshot_path), "%s", snapshot_path);
+    }
     play_game(game);
 
-    // Ask if they want to play again
-    char play_again;
-    printf("\nWould you like to play again? (y/n): ");
-    scanf(" %c", &play_again);
+    // Ask if they want to play again (a fully configured launch plays one game)
+    char play_again = 'n';
+    if (interactive) {
+        printf("\nWould you like to play again? (y/n): ");
+        scanf(" %c", &play_again);
+    }
 
     // Cleanup
     cleanup_game(game);
+    STATS_DUMP();
 
     if (play_again == 'y' || play_again == 'Y') {
         printf("\n");
-        main(); // Recursive call to restart
+        main(argc, argv); // Recursive call to restart
+    } else if (log_path) {
+        printf("\nThanks for playing! Check '%s' for game history.\n", log_path);
     } else {
-        printf("\nThanks for playing! Check '%s' for game history.\n", LOG_FILE);
+        printf("\nThanks for playing!\n");
     }
 
     return 0;
@@ -0,0 +1,186 @@
+#include "order.h"
+
+
+//Static prior per cell: central cells and cells on the diagonals take part in more lines
+
+void order_init(Engine *engine) {
+    MoveOrder *order = &engine->order;
+    int size = engine->size;
+
+    order->enabled = 1;
+    for (int cell = 0; cell < size * size; cell++) {
+        int distance = abs(2 * (cell / size) - (size - 1)) + abs(2 * (cell % size) - (size - 1));
+        order->prior[cell] = 4 * engine->cell_num_lines[cell] + 2 * (size - 1) - distance;
+    }
+    order_clear(order);
+}
+
+
+//Forget everything learned from earlier searches
+
+void order_clear(MoveOrder *order) {
+    memset(order->history, 0, sizeof(order->history));
+    memset(order->killers, 0xFF, sizeof(order->killers));
+    order->pv_len = 0;
+}
+
+
+//Start a search: killers are per ply of this search, older history counts half
+
+void order_start(MoveOrder *order) {
+    memset(order->killers, 0xFF, sizeof(order->killers));
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int cell = 0; cell < MAX_CELLS; cell++) {
+            order->history[p][cell] /= 2;
+        }
+    }
+    order->cutoffs = 0;
+    order->first_cutoffs = 0;
+}
+
+
+//Keep the principal variation of a finished search, so the next search
+//tries it first wherever it reaches one of its positions
+
+void order_save_pv(Engine *engine, const Position *root_pos, int root, const SearchResult *result) {
+    MoveOrder *order = &engine->order;
+    Position pos = *root_pos;
+
+    order->pv_len = 0;
+    for (int i = 0; i < result->pv_len; i++) {
+        order->pv_keys[i] = pos.hash ^ engine->zobrist_root[root];
+        order->pv_moves[i] = result->pv[i];
+        order->pv_len++;
+        if (position_make(engine, &pos, result->pv[i])) {
+            break;
+        }
+    }
+}
+
+
+//Line potential of a move for the side to move: lines it keeps for itself
+//count by how full they get, lines of a single opponent by how full they are;
+//*tactic is 2 if the move wins, 1 if it stops an opponent's win
+
+static int line_potential(Engine *engine, const Position *pos, int cell, int *tactic) {
+    int p = pos->to_move, np = pos->num_players, size = pos->size;
+    int score = 0;
+
+    *tactic = 0;
+    for (int k = 0; k < engine->cell_num_lines[cell]; k++) {
+        const unsigned char *count = pos->line_count[engine->cell_lines[cell][k]];
+        int owners = 0, other = 0;
+
+        for (int o = 0; o < np; o++) {
+            if (o != p && count[o]) {
+                owners++;
+                other = count[o];
+            }
+        }
+
+        if (owners == 0) {
+            if (count[p] == size - 1) *tactic = 2;
+            score += (count[p] + 1) * (count[p] + 1);
+        } else if (owners == 1 && count[p] == 0) {
+            if (other == size - 1 && *tactic == 0) *tactic = 1;
+            score += other * other;
+        }
+    }
+
+    return score;
+}
+
+
+//List the moves of a node with their ordering scores: hash move, wins, the
+//previous PV, blocks, killers, then history, prior and line potential
+
+int order_moves(Engine *engine, const Position *pos, uint64_t key, int ply, int tt_move, int *moves, int *scores) {
+    MoveOrder *order = &engine->order;
+    int p = pos->to_move;
+    int count = 0;
+
+    // Without ordering: hash move first, then the board in order
+    if (!order->enabled) {
+        for (int cell = 0; cell < pos->size * pos->size; cell++) {
+            if (!pos->cells[cell]) {
+                moves[count] = cell;
+                scores[count++] = cell == tt_move ? ORDER_HASH : -cell;
+            }
+        }
+        return count;
+    }
+
+    int pv_move = -1;
+    for (int i = 0; i < order->pv_len; i++) {
+        if (order->pv_keys[i] == key) {
+            pv_move = order->pv_moves[i];
+            break;
+        }
+    }
+    const int *killers = order->killers[ply];
+
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (pos->cells[cell]) {
+            continue;
+        }
+
+        int tactic;
+        int score = line_potential(engine, pos, cell, &tactic);
+        if (cell == tt_move) score = ORDER_HASH;
+        else if (tactic == 2) score = ORDER_WIN;
+        else if (cell == pv_move) score = ORDER_PV;
+        else if (tactic == 1) score = ORDER_BLOCK;
+        else if (cell == killers[0]) score = ORDER_KILLER + 1;
+        else if (cell == killers[1]) score = ORDER_KILLER;
+        else score += order->history[p][cell] + order->prior[cell];
+
+        moves[count] = cell;
+        scores[count++] = score;
+    }
+
+    return count;
+}
+
+
+//Move the best of the remaining moves to position i and return it
+
+int order_next(int *moves, int *scores, int count, int i) {
+    int best = i;
+    for (int j = i + 1; j < count; j++) {
+        if (scores[j] > scores[best]) best = j;
+    }
+
+    int move = moves[best], score = scores[best];
+    moves[best] = moves[i];
+    scores[best] = scores[i];
+    moves[i] = move;
+    scores[i] = score;
+    return move;
+}
+
+
+//Credit the move that caused a cutoff (index is its place in the order)
+
+void order_cutoff(MoveOrder *order, const Position *pos, int ply, int depth, int cell, int index) {
+    int *killers = order->killers[ply];
+    int *history = order->history[pos->to_move];
+
+    order->cutoffs++;
+    if (index == 0) {
+        order->first_cutoffs++;
+    }
+
+    if (killers[0] != cell) {
+        killers[1] = killers[0];
+        killers[0] = cell;
+    }
+
+    history[cell] += depth * depth;
+    if (history[cell] > ORDER_HISTORY_MAX) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            for (int c = 0; c < MAX_CELLS; c++) {
+                order->history[p][c] /= 2;
+            }
+        }
+    }
+}
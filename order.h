@@ -0,0 +1,24 @@
+#ifndef ORDER_H
+#define ORDER_H
+
+#include "engine.h"
+
+// Move score tiers, highest first (history and line potential stay below ORDER_KILLER)
+#define ORDER_HASH (1 << 30)
+#define ORDER_WIN (1 << 29)
+#define ORDER_PV (1 << 28)
+#define ORDER_BLOCK (1 << 27)
+#define ORDER_KILLER (1 << 26)
+#define ORDER_HISTORY_MAX (1 << 20)
+
+// Function prototypes
+void order_init(Engine *engine);
+void order_clear(MoveOrder *order);
+void order_start(MoveOrder *order);
+void order_save_pv(Engine *engine, const Position *root_pos, int root, const SearchResult *result);
+int order_moves(Engine *engine, const Position *pos, uint64_t key, int ply, int tt_move, int *moves, int *scores);
+int order_next(int *moves, int *scores, int count, int i);
+void order_cutoff(MoveOrder *order, const Position *pos, int ply, int depth, int cell, int index);
+
+
+#endif
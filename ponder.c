@@ -0,0 +1,140 @@
+#include "ponder.h"
+
+
+//Order the human's options, most dangerous for the computer first
+
+static int order_candidates(Engine *engine, Position *pos, int root, int *cells) {
+    int scores[MAX_CELLS];
+    int count = 0;
+
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (pos->cells[cell]) {
+            continue;
+        }
+
+        int score = position_make(engine, pos, cell) ? -WIN_SCORE : engine_evaluate(engine, pos, root);
+        position_unmake(engine, pos, cell);
+
+        // Insertion sort, lowest score (best for the human) first
+        int k = count++;
+        while (k > 0 && scores[k - 1] > score) {
+            scores[k] = scores[k - 1];
+            cells[k] = cells[k - 1];
+            k--;
+        }
+        scores[k] = score;
+        cells[k] = cell;
+    }
+
+    return count;
+}
+
+
+//Background thread: search a reply to each likely human move in turn
+
+static void* ponder_thread(void *arg) {
+    Engine *engine = (Engine*)arg;
+    Ponder *ponder = &engine->ponder;
+    Position pos = ponder->pos;
+    int cells[MAX_CELLS];
+    SearchResult result;
+
+    int count = order_candidates(engine, &pos, ponder->root, cells);
+
+    for (int i = 0; i < count && !atomic_load(&engine->stop); i++) {
+        int cell = cells[i];
+
+        // Nothing to reply to if this move ends the game
+        if (position_make(engine, &pos, cell) || pos.empty == 0) {
+            position_unmake(engine, &pos, cell);
+            continue;
+        }
+
+        engine_search(engine, &pos, ponder->root, ponder->think_ms, &result);
+        position_unmake(engine, &pos, cell);
+
+        // A search cut short by the human moving is left to computer_move
+        if (!atomic_load(&engine->stop)) {
+            ponder->reply[cell] = result.move;
+            ponder->ready[cell] = 1;
+            ponder->num_ready++;
+        }
+    }
+
+    return NULL;
+}
+
+
+//Start thinking during a human turn if the next seat is a searching computer
+
+int ponder_start(Engine *engine, Game *game) {
+    if (!engine || engine->ponder.active) {
+        return 0;
+    }
+
+    // Forget the last turn's replies first, so no early return leaves them to ponder_hit
+    Ponder *ponder = &engine->ponder;
+    ponder->root = -1;
+    ponder->num_ready = 0;
+    memset(ponder->ready, 0, sizeof(ponder->ready));
+
+    int next = (game->current_player + 1) % game->num_players;
+    if (game->players[next].type != COMPUTER || game->players[next].strategy != STRATEGY_SEARCH) {
+        return 0;
+    }
+
+    // Think with the limits of the seat that will reply
+    position_from_game(engine, &ponder->pos, game);
+    ponder->think_ms = game->players[next].think_ms ? game->players[next].think_ms : engine->think_ms;
+    engine->max_depth = game->players[next].max_depth;
+    ponder->root = next;
+
+    if (pthread_create(&ponder->thread, NULL, ponder_thread, engine) != 0) {
+        ponder->root = -1;
+        return 0;
+    }
+
+    ponder->active = 1;
+    return 1;
+}
+
+
+//Cancel the background search once the human has moved
+
+void ponder_stop(Engine *engine) {
+    if (!engine || !engine->ponder.active) {
+        return;
+    }
+
+    atomic_store(&engine->stop, 1);
+    pthread_join(engine->ponder.thread, NULL);
+    atomic_store(&engine->stop, 0);
+
+    engine->ponder.active = 0;
+}
+
+
+//Look up a finished reply to the move that led to pos
+
+int ponder_hit(Engine *engine, const Position *pos, int root, int *reply) {
+    Ponder *ponder = &engine->ponder;
+
+    if (ponder->active || ponder->root != root || ponder->num_ready == 0) {
+        return 0;
+    }
+
+    for (int cell = 0; cell < pos->size * pos->size; cell++) {
+        if (!ponder->pos.cells[cell] && pos->cells[cell]) {
+            Position predicted = ponder->pos;
+            position_make(engine, &predicted, cell);
+            if (predicted.hash != pos->hash || !ponder->ready[cell]) {
+                return 0;
+            }
+            *reply = ponder->reply[cell];
+            ponder->num_ready = 0;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include "engine.h"
+
+// Function prototypes
+int ponder_start(Engine *engine, Game *game);
+void ponder_stop(Engine *engine);
+int ponder_hit(Engine *engine, const Position *pos, int root, int *reply);
+
+
+#endif
@@ -0,0 +1,723 @@
+// Best-move queries for positions in bulk, answers are kept in a persistent cache
+//
+// Build: gcc -O2 -pthread query.c engine.c order.c eval.c solver.c tt.c rng.c stats.c -o query
+// Usage: query [options] [FILE...]   (reads stdin when no file is given)
+//   --players P    players when a line does not say (default 2)
+//   --depth D      search to depth D (default: time limited)
+//   --think MS     time per position without --depth (default 1000)
+//   --solve N      solve exactly once N or fewer cells are empty (default 14, 0 to disable)
+//   --threads N    worker threads (default: all cores)
+//   --hash MB      transposition table per board and thread (default 16)
+//   --cache FILE   answer cache (default query_cache.bin), off for none
+//
+// Each line is "[PLAYERS] BOARD" where BOARD lists the rows, optionally
+// separated by '/', with '.' or '-' for empty cells and X, O, Z for the
+// players, e.g. "X.O/.X./..O" or "3 XOZ/.../...". The side to move follows
+// from the piece counts (X moves first). Lines starting with # are skipped.
+//
+// Positions are reduced to one of their 8 symmetric forms before the lookup,
+// so a rotated or mirrored board is answered from the same cache entry.
+// A cached answer is reused when it is exact or its search had at least the
+// depth (with --depth) or the think time asked for; answers from a search
+// that did not finish one iteration are never cached.
+// Output: the board, the best move (row col), the score for the side to
+// move, the depth, "exact" or "search", and "cached" or "new".
+
+#include <unistd.h>
+#include "eval.h"
+
+#define QUERY_CACHE_FILE "query_cache.bin"
+#define QUERY_MAGIC "TTTQ"
+#define QUERY_VERSION 2
+#define KEY_BYTES (2 + (MAX_CELLS + 3) / 4)
+#define RECORD_BYTES (KEY_BYTES + 15)
+#define MAX_LINE 256
+
+// Answer for a canonical position: key is size, players and the board at
+// 2 bits per cell, move is a cell of the canonical board, think_ms is the
+// time the search had (0 when it was limited by depth instead)
+typedef struct {
+    unsigned char key[KEY_BYTES];
+    int move;
+    int score;
+    int depth;
+    int exact;
+    int think_ms;
+} Answer;
+
+// Answers by key, open addressing over indexes into entries
+typedef struct {
+    Answer *entries;
+    int count;
+    int capacity;
+    int *slots;
+    int num_slots;
+} Cache;
+
+// Query states
+typedef enum {
+    QUERY_INVALID,
+    QUERY_OVER,
+    QUERY_CACHED,
+    QUERY_NEW
+} QueryStatus;
+
+// One input line
+typedef struct {
+    char board[MAX_LINE];
+    int transform;
+    unsigned char key[KEY_BYTES];
+    QueryStatus status;
+    int answer;
+} Query;
+
+// Settings, queries and the positions still to search, shared by the workers
+typedef struct {
+    int num_players;
+    int depth;
+    int think_ms;
+    int solve_empty;
+    int threads;
+    size_t hash_mb;
+    const char *cache_file;
+
+    Query *queries;
+    int num_queries;
+    int query_capacity;
+    Answer *jobs;
+    int num_jobs;
+    atomic_int next_job;
+
+    Cache cache;
+    Cache pending;
+    int cache_clean;
+} Service;
+
+
+//FNV-1a over a key
+
+static uint64_t key_hash(const unsigned char *key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < KEY_BYTES; i++) {
+        hash = (hash ^ key[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//Index of an answer in the cache, -1 if it is not there
+
+static int cache_find(const Cache *cache, const unsigned char *key) {
+    if (!cache->num_slots) {
+        return -1;
+    }
+
+    int mask = cache->num_slots - 1;
+    for (int s = (int)(key_hash(key) & mask); cache->slots[s] >= 0; s = (s + 1) & mask) {
+        if (memcmp(cache->entries[cache->slots[s]].key, key, KEY_BYTES) == 0) {
+            return cache->slots[s];
+        }
+    }
+    return -1;
+}
+
+
+//Add or replace an answer, returns its index or -1 when out of memory
+
+static int cache_put(Cache *cache, const Answer *answer) {
+    int index = cache_find(cache, answer->key);
+    if (index >= 0) {
+        cache->entries[index] = *answer;
+        return index;
+    }
+
+    if (cache->count == cache->capacity) {
+        int capacity = cache->capacity ? cache->capacity * 2 : 1024;
+        Answer *entries = (Answer*)realloc(cache->entries, capacity * sizeof(Answer));
+        if (!entries) {
+            printf("Memory allocation failed!\n");
+            return -1;
+        }
+        cache->entries = entries;
+        cache->capacity = capacity;
+    }
+
+    // Keep the slots at most half full
+    if ((cache->count + 1) * 2 > cache->num_slots) {
+        int num_slots = cache->num_slots ? cache->num_slots * 2 : 2048;
+        int *slots = (int*)malloc(num_slots * sizeof(int));
+        if (!slots) {
+            printf("Memory allocation failed!\n");
+            return -1;
+        }
+        memset(slots, 0xFF, num_slots * sizeof(int));
+        for (int i = 0; i < cache->count; i++) {
+            int s = (int)(key_hash(cache->entries[i].key) & (num_slots - 1));
+            while (slots[s] >= 0) s = (s + 1) & (num_slots - 1);
+            slots[s] = i;
+        }
+        free(cache->slots);
+        cache->slots = slots;
+        cache->num_slots = num_slots;
+    }
+
+    index = cache->count++;
+    cache->entries[index] = *answer;
+    int s = (int)(key_hash(answer->key) & (cache->num_slots - 1));
+    while (cache->slots[s] >= 0) s = (s + 1) & (cache->num_slots - 1);
+    cache->slots[s] = index;
+    return index;
+}
+
+static void cache_free(Cache *cache) {
+    free(cache->entries);
+    free(cache->slots);
+    memset(cache, 0, sizeof(Cache));
+}
+
+
+//FNV-1a over the bytes of a file record
+
+static uint32_t checksum(const unsigned char *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+//Record layout: key, move, depth, exact flag, score and think_ms (int32
+//little-endian) and a 32-bit checksum of the bytes before it
+
+static void encode_record(const Answer *answer, unsigned char *out) {
+    memcpy(out, answer->key, KEY_BYTES);
+    out[KEY_BYTES] = (unsigned char)answer->move;
+    out[KEY_BYTES + 1] = (unsigned char)answer->depth;
+    out[KEY_BYTES + 2] = (unsigned char)answer->exact;
+    for (int i = 0; i < 4; i++) {
+        out[KEY_BYTES + 3 + i] = (unsigned char)((uint32_t)answer->score >> (8 * i));
+        out[KEY_BYTES + 7 + i] = (unsigned char)((uint32_t)answer->think_ms >> (8 * i));
+    }
+    uint32_t sum = checksum(out, RECORD_BYTES - 4);
+    for (int i = 0; i < 4; i++) {
+        out[RECORD_BYTES - 4 + i] = (unsigned char)(sum >> (8 * i));
+    }
+}
+
+static int decode_record(const unsigned char *in, Answer *answer) {
+    const unsigned char *tail = in + RECORD_BYTES - 4;
+    uint32_t sum = (uint32_t)tail[0] | (uint32_t)tail[1] << 8 | (uint32_t)tail[2] << 16 | (uint32_t)tail[3] << 24;
+    if (checksum(in, RECORD_BYTES - 4) != sum) {
+        return 0;
+    }
+
+    memcpy(answer->key, in, KEY_BYTES);
+    answer->move = in[KEY_BYTES];
+    answer->depth = in[KEY_BYTES + 1];
+    answer->exact = in[KEY_BYTES + 2];
+    answer->score = (int32_t)((uint32_t)in[KEY_BYTES + 3] | (uint32_t)in[KEY_BYTES + 4] << 8 |
+                              (uint32_t)in[KEY_BYTES + 5] << 16 | (uint32_t)in[KEY_BYTES + 6] << 24);
+    answer->think_ms = (int32_t)((uint32_t)in[KEY_BYTES + 7] | (uint32_t)in[KEY_BYTES + 8] << 8 |
+                                 (uint32_t)in[KEY_BYTES + 9] << 16 | (uint32_t)in[KEY_BYTES + 10] << 24);
+    return 1;
+}
+
+
+//Only answers from a search that finished at least one iteration are kept
+
+static int cacheable(const Answer *answer) {
+    return answer->move >= 0 && answer->depth > 0;
+}
+
+
+//A cached answer counts if it is exact, or if its search had at least the
+//budget asked for: as deep for --depth, as much time otherwise
+
+static int reusable(const Service *s, const Answer *answer) {
+    if (answer->exact) {
+        return 1;
+    }
+    if (s->depth > 0) {
+        return answer->depth >= s->depth;
+    }
+    return answer->think_ms >= s->think_ms;
+}
+
+
+//Load the cache file, a damaged tail is dropped and the file rewritten on save
+
+static int load_cache(Service *s) {
+    unsigned char header[8], record[RECORD_BYTES];
+    Answer answer;
+
+    s->cache_clean = 0;
+    FILE *file = fopen(s->cache_file, "rb");
+    if (!file) {
+        return 1;
+    }
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, QUERY_MAGIC, 4) != 0 || header[4] != QUERY_VERSION) {
+        printf("# Warning: '%s' is not a query cache, starting a new one\n", s->cache_file);
+        fclose(file);
+        return 1;
+    }
+
+    size_t got;
+    while ((got = fread(record, 1, RECORD_BYTES, file)) == RECORD_BYTES && decode_record(record, &answer)) {
+        if (cache_put(&s->cache, &answer) < 0) {
+            fclose(file);
+            return 0;
+        }
+    }
+    s->cache_clean = got == 0 && feof(file);
+    fclose(file);
+    return 1;
+}
+
+
+//Append the new answers, or write the whole cache if the file needs it
+
+static int save_cache(Service *s) {
+    unsigned char header[8] = {'T', 'T', 'T', 'Q', QUERY_VERSION, 0, 0, 0};
+    unsigned char record[RECORD_BYTES];
+    char tmp_name[MAX_LINE];
+
+    if (s->num_jobs == 0) {
+        return 1;
+    }
+
+    if (s->cache_clean) {
+        FILE *file = fopen(s->cache_file, "ab");
+        if (!file) {
+            printf("# Could not write '%s'\n", s->cache_file);
+            return 0;
+        }
+        int ok = 1;
+        for (int i = 0; i < s->num_jobs && ok; i++) {
+            if (cacheable(&s->jobs[i])) {
+                encode_record(&s->jobs[i], record);
+                ok = fwrite(record, 1, RECORD_BYTES, file) == RECORD_BYTES;
+            }
+        }
+        return fclose(file) == 0 && ok;
+    }
+
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", s->cache_file);
+    FILE *file = fopen(tmp_name, "wb");
+    if (!file) {
+        printf("# Could not write '%s'\n", tmp_name);
+        return 0;
+    }
+    int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    for (int i = 0; i < s->cache.count && ok; i++) {
+        encode_record(&s->cache.entries[i], record);
+        ok = fwrite(record, 1, RECORD_BYTES, file) == RECORD_BYTES;
+    }
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(tmp_name, s->cache_file) == 0;
+}
+
+
+//Cell a board cell moves to under one of the 8 symmetries
+//(bit 0 mirrors the columns, bit 1 the rows, bit 2 transposes)
+
+static int transform_cell(int t, int cell, int size) {
+    int row = cell / size, col = cell % size;
+
+    if (t & 1) col = size - 1 - col;
+    if (t & 2) row = size - 1 - row;
+    if (t & 4) {
+        int tmp = row;
+        row = col;
+        col = tmp;
+    }
+    return row * size + col;
+}
+
+
+//Smallest of the symmetric forms of a board, returns the symmetry used
+
+static int canonicalize(const unsigned char *cells, int size, unsigned char *canon) {
+    unsigned char form[MAX_CELLS];
+    int best = 0;
+
+    for (int t = 0; t < 8; t++) {
+        for (int cell = 0; cell < size * size; cell++) {
+            form[transform_cell(t, cell, size)] = cells[cell];
+        }
+        if (t == 0 || memcmp(form, canon, size * size) < 0) {
+            memcpy(canon, form, size * size);
+            best = t;
+        }
+    }
+
+    return best;
+}
+
+static void pack_key(const unsigned char *cells, int size, int num_players, unsigned char *key) {
+    memset(key, 0, KEY_BYTES);
+    key[0] = (unsigned char)size;
+    key[1] = (unsigned char)num_players;
+    for (int cell = 0; cell < size * size; cell++) {
+        key[2 + cell / 4] |= (unsigned char)(cells[cell] << (2 * (cell % 4)));
+    }
+}
+
+
+//Search position for a board, returns 1 if the game is already over
+
+static int build_position(Engine *engine, const unsigned char *cells, Position *pos) {
+    int total = 0, over = 0;
+
+    position_init(engine, pos);
+    for (int cell = 0; cell < engine->size * engine->size; cell++) {
+        if (cells[cell]) {
+            pos->to_move = cells[cell] - 1;
+            over |= position_make(engine, pos, cell);
+            total++;
+        }
+    }
+
+    int to_move = total % engine->num_players;
+    pos->hash ^= engine->zobrist_side[pos->to_move] ^ engine->zobrist_side[to_move];
+    pos->to_move = to_move;
+    return over || pos->empty == 0;
+}
+
+
+//Parse "[PLAYERS] BOARD", returns the board size or 0 if the line is not a
+//position that can arise in play
+
+static int parse_position(Query *query, const char *line, int default_players, int *num_players,
+                          unsigned char *cells) {
+    int count[MAX_PLAYERS] = {0};
+    int n = 0, np = default_players;
+    const char *in = line;
+
+    while (*in == ' ' || *in == '\t') in++;
+    if ((in[0] == '2' || in[0] == '3') && (in[1] == ' ' || in[1] == '\t')) {
+        np = in[0] - '0';
+        in += 2;
+        while (*in == ' ' || *in == '\t') in++;
+    }
+
+    int len = (int)strcspn(in, " \t\r\n");
+    snprintf(query->board, sizeof(query->board), "%.*s", len, in);
+
+    for (int i = 0; i < len; i++) {
+        char c = in[i];
+        int p;
+
+        if (c == '/') continue;
+        if (c == '.' || c == '-') p = 0;
+        else if (c == 'X' || c == 'x') p = 1;
+        else if (c == 'O' || c == 'o') p = 2;
+        else if (c == 'Z' || c == 'z') p = 3;
+        else return 0;
+
+        if (n == MAX_CELLS || p > np) return 0;
+        if (p) count[p - 1]++;
+        cells[n++] = (unsigned char)p;
+    }
+
+    int size = MIN_SIZE;
+    while (size < MAX_SIZE && size * size < n) size++;
+    if (size * size != n) {
+        return 0;
+    }
+
+    // Players move in turn starting with X
+    int total = count[0] + count[1] + count[2];
+    for (int p = 0; p < np; p++) {
+        if (count[p] != total / np + (p < total % np)) {
+            return 0;
+        }
+    }
+
+    *num_players = np;
+    return size;
+}
+
+
+//Line tables for a board, created on first use
+
+static Engine* board_engine(Engine *engines[MAX_SIZE + 1][MAX_PLAYERS + 1], int size, int num_players,
+                            size_t hash_mb) {
+    if (!engines[size][num_players]) {
+        engines[size][num_players] = engine_create(size, num_players, hash_mb);
+    }
+    return engines[size][num_players];
+}
+
+
+//Read queries, answering from the cache and queueing the rest once each
+
+static int read_queries(Service *s, FILE *in, Engine *tables[MAX_SIZE + 1][MAX_PLAYERS + 1]) {
+    char line[MAX_LINE];
+
+    while (fgets(line, sizeof(line), in)) {
+        const char *text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0') {
+            continue;
+        }
+
+        if (s->num_queries == s->query_capacity) {
+            int capacity = s->query_capacity ? s->query_capacity * 2 : 256;
+            Query *queries = (Query*)realloc(s->queries, capacity * sizeof(Query));
+            if (!queries) {
+                printf("Memory allocation failed!\n");
+                return 0;
+            }
+            s->queries = queries;
+            s->query_capacity = capacity;
+        }
+
+        Query *query = &s->queries[s->num_queries++];
+        unsigned char cells[MAX_CELLS], canon[MAX_CELLS];
+        int num_players;
+        Position pos;
+
+        memset(query, 0, sizeof(Query));
+        int size = parse_position(query, text, s->num_players, &num_players, cells);
+        Engine *engine = size ? board_engine(tables, size, num_players, 0) : NULL;
+        if (!engine) {
+            query->status = QUERY_INVALID;
+            continue;
+        }
+        if (build_position(engine, cells, &pos)) {
+            query->status = QUERY_OVER;
+            continue;
+        }
+
+        query->transform = canonicalize(cells, size, canon);
+        pack_key(canon, size, num_players, query->key);
+
+        int index = cache_find(&s->cache, query->key);
+        if (index >= 0 && reusable(s, &s->cache.entries[index])) {
+            query->status = QUERY_CACHED;
+            query->answer = index;
+            continue;
+        }
+
+        Answer job = {.move = -1};
+        memcpy(job.key, query->key, KEY_BYTES);
+        query->status = QUERY_NEW;
+        query->answer = cache_find(&s->pending, query->key);
+        if (query->answer < 0 && (query->answer = cache_put(&s->pending, &job)) < 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+//Worker thread: search queued positions until none are left
+
+static void* worker_thread(void *arg) {
+    Service *s = (Service*)arg;
+    Engine *engines[MAX_SIZE + 1][MAX_PLAYERS + 1] = {{NULL}};
+    int i;
+
+    while ((i = atomic_fetch_add(&s->next_job, 1)) < s->num_jobs) {
+        Answer *job = &s->jobs[i];
+        int size = job->key[0], num_players = job->key[1];
+        unsigned char cells[MAX_CELLS];
+        Position pos;
+        SearchResult result;
+
+        Engine *engine = engines[size][num_players];
+        if (!engine) {
+            char eval_file[64];
+            if (!(engine = board_engine(engines, size, num_players, s->hash_mb))) {
+                continue;
+            }
+            eval_file_name(eval_file, sizeof(eval_file), size, num_players);
+            eval_load(engine, eval_file);
+            engine->max_depth = s->depth;
+            engine->solve_empty = s->solve_empty;
+        }
+
+        for (int cell = 0; cell < size * size; cell++) {
+            cells[cell] = (job->key[2 + cell / 4] >> (2 * (cell % 4))) & 3;
+        }
+        build_position(engine, cells, &pos);
+        engine_search(engine, &pos, pos.to_move, s->depth ? -1 : s->think_ms, &result);
+
+        job->move = result.move;
+        job->score = result.score;
+        job->depth = result.depth;
+        job->think_ms = s->depth ? 0 : s->think_ms;
+        job->exact = result.depth >= pos.empty ||
+                     result.score > WIN_SCORE - MAX_PLY || result.score < -WIN_SCORE + MAX_PLY;
+    }
+
+    for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+        for (int np = 2; np <= MAX_PLAYERS; np++) {
+            engine_destroy(engines[size][np]);
+        }
+    }
+    return NULL;
+}
+
+
+//Print the answers in input order, returns how many came from the cache
+
+static int print_answers(const Service *s) {
+    int cached = 0;
+
+    for (int i = 0; i < s->num_queries; i++) {
+        const Query *query = &s->queries[i];
+
+        if (query->status == QUERY_INVALID) {
+            printf("%s  invalid\n", query->board);
+            continue;
+        }
+        if (query->status == QUERY_OVER) {
+            printf("%s  over\n", query->board);
+            continue;
+        }
+
+        const Answer *answer = query->status == QUERY_CACHED ? &s->cache.entries[query->answer]
+                                                             : &s->jobs[query->answer];
+        if (answer->move < 0) {
+            printf("%s  failed\n", query->board);
+            continue;
+        }
+        cached += query->status == QUERY_CACHED;
+
+        int size = query->key[0];
+        int cell = 0;
+        while (transform_cell(query->transform, cell, size) != answer->move) cell++;
+
+        printf("%s  best %d %d  score %d  depth %d  %s  %s\n", query->board,
+               cell / size + 1, cell % size + 1, answer->score, answer->depth,
+               answer->exact ? "exact" : "search", query->status == QUERY_CACHED ? "cached" : "new");
+    }
+
+    return cached;
+}
+
+
+//Read the command line, returns the index of the first input file
+
+static int parse_args(Service *s, int argc, char **argv) {
+    s->num_players = 2;
+    s->think_ms = ENGINE_THINK_MS;
+    s->solve_empty = SOLVER_EMPTY_CELLS;
+    s->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    s->hash_mb = ENGINE_TT_MB;
+    s->cache_file = QUERY_CACHE_FILE;
+
+    int i;
+    for (i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+        const char *arg = argv[i], *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!value) {
+            printf("Missing value for %s\n", arg);
+            return 0;
+        }
+        if (strcmp(arg, "--players") == 0) s->num_players = atoi(value);
+        else if (strcmp(arg, "--depth") == 0) s->depth = atoi(value);
+        else if (strcmp(arg, "--think") == 0) s->think_ms = atoi(value);
+        else if (strcmp(arg, "--solve") == 0) s->solve_empty = atoi(value);
+        else if (strcmp(arg, "--threads") == 0) s->threads = atoi(value);
+        else if (strcmp(arg, "--hash") == 0) s->hash_mb = (size_t)atoi(value);
+        else if (strcmp(arg, "--cache") == 0) s->cache_file = strcmp(value, "off") == 0 ? NULL : value;
+        else {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+    }
+
+    if (s->num_players < 2 || s->num_players > MAX_PLAYERS || s->depth < 0 || s->depth > MAX_PLY ||
+        s->threads < 1 || s->think_ms < 1) {
+        printf("Usage: query [--players P] [--depth D] [--think MS] [--solve N] [--threads N]\n"
+               "             [--hash MB] [--cache FILE|off] [FILE...]\n");
+        return 0;
+    }
+
+    return i;
+}
+
+
+int main(int argc, char **argv) {
+    static Service s;
+    Engine *tables[MAX_SIZE + 1][MAX_PLAYERS + 1] = {{NULL}};
+    struct timespec started;
+
+    int first = parse_args(&s, argc, argv);
+    if (!first || (s.cache_file && !load_cache(&s))) {
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    int ok = 1;
+    if (first == argc) {
+        ok = read_queries(&s, stdin, tables);
+    }
+    for (int i = first; i < argc && ok; i++) {
+        FILE *in = fopen(argv[i], "r");
+        if (!in) {
+            printf("Could not open '%s'\n", argv[i]);
+            return 1;
+        }
+        ok = read_queries(&s, in, tables);
+        fclose(in);
+    }
+    if (!ok) {
+        return 1;
+    }
+
+    // Search the new positions across the workers
+    s.jobs = s.pending.entries;
+    s.num_jobs = s.pending.count;
+    int threads = s.threads < s.num_jobs ? s.threads : s.num_jobs;
+    pthread_t *ids = (pthread_t*)malloc((threads ? threads : 1) * sizeof(pthread_t));
+    if (!ids) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+
+    // Workers share the queue, so fewer threads is only slower; with none
+    // started the searches run on this thread
+    int workers = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&ids[workers], NULL, worker_thread, &s) == 0) {
+            workers++;
+        }
+    }
+    if (!workers && s.num_jobs) {
+        worker_thread(&s);
+    }
+    for (int i = 0; i < workers; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    int cached = print_answers(&s);
+
+    for (int i = 0; i < s.num_jobs; i++) {
+        if (cacheable(&s.jobs[i]) && cache_put(&s.cache, &s.jobs[i]) < 0) {
+            return 1;
+        }
+    }
+    if (s.cache_file && !save_cache(&s)) {
+        return 1;
+    }
+
+    printf("# %d positions, %d answered from the cache, %d searched, in %.3f s with %d threads\n",
+           s.num_queries, cached, s.num_jobs, elapsed_ms_since(&started) / 1000.0, threads);
+
+    for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+        for (int np = 2; np <= MAX_PLAYERS; np++) {
+            engine_destroy(tables[size][np]);
+        }
+    }
+    free(ids);
+    free(s.queries);
+    cache_free(&s.pending);
+    cache_free(&s.cache);
+    return 0;
+}
@@ -0,0 +1,556 @@
+// Replay benchmark: recorded games are re-run through the game core and the
+// search engine, timing every phase of every move
+//
+// Build: gcc -O2 -pthread replay.c tictactoe.c snapshot.c config.c ponder.c batch.c engine.c order.c
+//            eval.c solver.c tt.c rng.c stats.c -o replay
+// Usage: replay [options] [FILE...]   (reads game_log.txt when no file is given)
+//   --depth D      engine decision depth (default 3, 0 skips the engine phase)
+//   --think MS     time-limited engine decisions instead of a fixed depth
+//   --solve N      solve exactly once N or fewer cells are empty (default 14, 0 to disable)
+//   --runs N       replay every game N times (default 1)
+//   --csv FILE     write every sample as phase,game,move,ns
+//
+// FILE is a game log written by log_move (several logs may be concatenated)
+// or a snapshot file (game_snapshot.bin). Each move goes through the phases
+// the game loop uses: engine decision on the position before the move,
+// validate_move, make_move, then check_win and check_draw. The replayed
+// result must match the recorded one (win, draw, or still going), and the
+// engine's choices are compared with the recorded moves.
+
+#include "engine.h"
+#include "snapshot.h"
+
+// Constants
+#define REPLAY_LOG_LINE 512
+#define REPLAY_ONGOING -2
+#define REPLAY_DRAW -1
+
+// Phases of a move, in the order they run
+typedef enum {
+    PHASE_ENGINE,
+    PHASE_VALIDATE,
+    PHASE_APPLY,
+    PHASE_WIN_CHECK,
+    NUM_PHASES
+} Phase;
+
+static const char *phase_names[NUM_PHASES] = {"engine", "validate", "apply", "win check"};
+
+// One recorded game: start holds the seat + 1 of cells already taken when a
+// logged game was resumed (their order is not in the log), result is the
+// winning seat, REPLAY_DRAW or REPLAY_ONGOING
+typedef struct {
+    int size;
+    int num_players;
+    uint64_t seed;
+    unsigned char start[MAX_CELLS];
+    int start_moves;
+    unsigned char moves[MAX_CELLS];
+    int num_moves;
+    int result;
+} Recording;
+
+// Recordings read so far
+typedef struct {
+    Recording *games;
+    int count;
+    int capacity;
+} RecordingList;
+
+// Latencies of one phase in nanoseconds
+typedef struct {
+    long long *values;
+    size_t count;
+    size_t capacity;
+} Samples;
+
+// Command line options
+typedef struct {
+    int depth;
+    int think_ms;
+    int solve_empty;
+    int runs;
+    const char *csv_path;
+} Options;
+
+static const char symbols[] = {'X', 'O', 'Z'};
+
+
+static long long ns_between(const struct timespec *a, const struct timespec *b) {
+    return (long long)(b->tv_sec - a->tv_sec) * 1000000000LL + (b->tv_nsec - a->tv_nsec);
+}
+
+
+static int seat_of(char symbol, int num_players) {
+    for (int p = 0; p < num_players; p++) {
+        if (symbols[p] == symbol) return p;
+    }
+    return -1;
+}
+
+
+//Append an empty recording, NULL if out of memory
+
+static Recording* add_recording(RecordingList *list) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? 2 * list->capacity : 16;
+        Recording *games = (Recording*)realloc(list->games, (size_t)capacity * sizeof(Recording));
+        if (!games) {
+            printf("Memory allocation failed!\n");
+            return NULL;
+        }
+        list->games = games;
+        list->capacity = capacity;
+    }
+
+    Recording *rec = &list->games[list->count++];
+    memset(rec, 0, sizeof(Recording));
+    rec->result = REPLAY_ONGOING;
+    return rec;
+}
+
+
+//Read a board row as written by log_game_state ("| X | O |   |")
+
+static int parse_board_row(Recording *rec, int row, const char *line) {
+    for (int col = 0; col < rec->size; col++) {
+        const char *cell = line + 2 + 4 * col;
+        if ((size_t)(cell - line) >= strlen(line)) {
+            return 0;
+        }
+        if (*cell != ' ') {
+            int seat = seat_of(*cell, rec->num_players);
+            if (seat < 0) {
+                return 0;
+            }
+            rec->start[row * rec->size + col] = (unsigned char)(seat + 1);
+            rec->start_moves++;
+        }
+    }
+    return 1;
+}
+
+
+//Read every game of a text log, returns 0 on a malformed line
+
+static int read_log(RecordingList *list, FILE *file, const char *path) {
+    char line[REPLAY_LOG_LINE];
+    Recording *rec = NULL;
+    int line_number = 0, board_rows = -1;
+
+    while (fgets(line, sizeof(line), file)) {
+        int size, num_players, row, col;
+        unsigned long long seed;
+        char symbol;
+        line_number++;
+
+        // A resumed game's log starts with the board it was resumed from
+        if (board_rows >= 0 && line[0] == '|') {
+            if (!parse_board_row(rec, board_rows++, line)) {
+                printf("%s:%d: invalid board row\n", path, line_number);
+                return 0;
+            }
+            if (board_rows == rec->size) board_rows = -1;
+            continue;
+        }
+
+        if (strncmp(line, "=== NEW TIC-TAC-TOE GAME ===", 28) == 0) {
+            if (!(rec = add_recording(list))) {
+                return 0;
+            }
+        } else if (!rec) {
+            continue;
+        } else if (sscanf(line, "Board Size: %dx", &size) == 1) {
+            if (size < MIN_SIZE || size > MAX_SIZE) {
+                printf("%s:%d: invalid board size\n", path, line_number);
+                return 0;
+            }
+            rec->size = size;
+        } else if (sscanf(line, "Number of Players: %d", &num_players) == 1) {
+            if (num_players < 2 || num_players > MAX_PLAYERS) {
+                printf("%s:%d: invalid number of players\n", path, line_number);
+                return 0;
+            }
+            rec->num_players = num_players;
+        } else if (sscanf(line, "Seed: %llu", &seed) == 1) {
+            rec->seed = seed;
+        } else if (strncmp(line, "Resumed after", 13) == 0) {
+            if (rec->num_moves > 0 || rec->start_moves > 0 || !rec->size) {
+                printf("%s:%d: unexpected resume\n", path, line_number);
+                return 0;
+            }
+            board_rows = 0;
+        } else if (sscanf(line, "Move: %*s (%c) -> Position (%d, %d)", &symbol, &row, &col) == 3) {
+            int played = rec->start_moves + rec->num_moves;
+            if (!rec->size || !rec->num_players || row < 1 || row > rec->size || col < 1 || col > rec->size ||
+                played >= rec->size * rec->size || seat_of(symbol, rec->num_players) != played % rec->num_players) {
+                printf("%s:%d: invalid move\n", path, line_number);
+                return 0;
+            }
+            rec->moves[rec->num_moves++] = (unsigned char)((row - 1) * rec->size + (col - 1));
+        } else if (strncmp(line, "GAME RESULT: DRAW!", 18) == 0) {
+            rec->result = REPLAY_DRAW;
+        } else if (strncmp(line, "GAME RESULT:", 12) == 0) {
+            const char *paren = strrchr(line, '(');
+            rec->result = paren ? seat_of(paren[1], rec->num_players) : -1;
+            if (rec->result < 0) {
+                printf("%s:%d: invalid result\n", path, line_number);
+                return 0;
+            }
+        }
+    }
+
+    // Drop a header with no board (e.g. a log cut off while being written)
+    if (rec && (!rec->size || !rec->num_players)) {
+        list->count--;
+    }
+    return 1;
+}
+
+
+//Game of the right size and player count to replay on, created on first use
+
+static Game* board_game(Game *games[MAX_SIZE + 1][MAX_PLAYERS + 1], int size, int num_players) {
+    if (!games[size][num_players]) {
+        Game *game = initialize_game(size, num_players, 0, NULL);
+        if (!game) {
+            return NULL;
+        }
+        for (int p = 0; p < num_players; p++) {
+            Player *player = &game->players[p];
+            player->symbol = symbols[p];
+            player->type = COMPUTER;
+            player->strategy = STRATEGY_SEARCH;
+            player->max_depth = 0;
+            player->think_ms = 0;
+            sprintf(player->name, "Replay_%d", p + 1);
+        }
+        games[size][num_players] = game;
+    }
+    return games[size][num_players];
+}
+
+
+//Read a snapshot file's game into a recording
+
+static int read_snapshot_file(RecordingList *list, const unsigned char *buf, size_t len, const char *path,
+                              Game *games[MAX_SIZE + 1][MAX_PLAYERS + 1]) {
+    int size, num_players;
+    if (!snapshot_peek(buf, len, &size, &num_players)) {
+        printf("'%s' is not a valid snapshot\n", path);
+        return 0;
+    }
+
+    Game *game = board_game(games, size, num_players);
+    Recording *rec = game ? add_recording(list) : NULL;
+    if (!rec) {
+        return 0;
+    }
+    if (!snapshot_unpack(game, buf, len)) {
+        printf("'%s' is not a valid snapshot\n", path);
+        list->count--;
+        return 0;
+    }
+
+    rec->size = size;
+    rec->num_players = num_players;
+    rec->seed = game->seed;
+    rec->num_moves = game->num_moves;
+    memcpy(rec->moves, game->moves, (size_t)game->num_moves);
+    return 1;
+}
+
+
+//Read a log or snapshot file, told apart by the snapshot magic
+
+static int read_file(RecordingList *list, const char *path, Game *games[MAX_SIZE + 1][MAX_PLAYERS + 1]) {
+    unsigned char buf[SNAPSHOT_MAX_BYTES];
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("Could not open '%s'\n", path);
+        return 0;
+    }
+
+    size_t len = fread(buf, 1, sizeof(buf), file);
+    int ok;
+    if (len >= 4 && memcmp(buf, SNAPSHOT_MAGIC, 4) == 0) {
+        ok = read_snapshot_file(list, buf, len, path, games);
+    } else {
+        rewind(file);
+        ok = read_log(list, file, path);
+    }
+
+    fclose(file);
+    return ok;
+}
+
+
+static int add_sample(Samples *samples, long long ns) {
+    if (samples->count == samples->capacity) {
+        size_t capacity = samples->capacity ? 2 * samples->capacity : 1024;
+        long long *values = (long long*)realloc(samples->values, capacity * sizeof(long long));
+        if (!values) {
+            printf("Memory allocation failed!\n");
+            return 0;
+        }
+        samples->values = values;
+        samples->capacity = capacity;
+    }
+    samples->values[samples->count++] = ns;
+    return 1;
+}
+
+
+//Put the game back at the recording's starting position, with fresh engine tables
+
+static void reset_game(Game *game, const Recording *rec) {
+    for (int i = 0; i < game->size; i++) {
+        for (int j = 0; j < game->size; j++) {
+            int seat = rec->start[i * game->size + j];
+            game->board[i][j] = seat ? symbols[seat - 1] : ' ';
+        }
+    }
+    game->num_moves = 0;
+    game->current_player = rec->start_moves % game->num_players;
+    game->seed = rec->seed;
+    rng_seed(&game->rng, rec->seed, 0);
+
+    if (game->engine) {
+        engine_new_game(game->engine);
+    }
+}
+
+
+//Replay one recording, returns 1 if the replayed result matches the recorded one,
+//0 if not, -1 if out of memory
+
+static int replay_game(Game *game, const Recording *rec, int index, const Options *opt,
+                       Samples samples[NUM_PHASES], FILE *csv, long long *agreed, long long *decisions) {
+    struct timespec t[5];
+    int result = REPLAY_ONGOING;
+    int decide = (opt->depth > 0 || opt->think_ms > 0) && game->engine;
+
+    reset_game(game, rec);
+
+    for (int m = 0; m < rec->num_moves; m++) {
+        int row = rec->moves[m] / rec->size, col = rec->moves[m] % rec->size;
+        long long ns[NUM_PHASES];
+
+        // Engine decision on the position before the move, as computer_move does it
+        clock_gettime(CLOCK_MONOTONIC, &t[0]);
+        if (decide) {
+            Engine *engine = game->engine;
+            Position pos;
+            SearchResult decision;
+
+            position_from_game(engine, &pos, game);
+            engine->max_depth = opt->think_ms > 0 ? 0 : opt->depth;
+            engine->solve_empty = opt->solve_empty;
+            engine_search(engine, &pos, game->current_player, opt->think_ms > 0 ? opt->think_ms : -1, &decision);
+            *agreed += decision.move == rec->moves[m];
+            (*decisions)++;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t[1]);
+        int valid = validate_move(game, row, col);
+        clock_gettime(CLOCK_MONOTONIC, &t[2]);
+        if (valid) make_move(game, row, col);
+        clock_gettime(CLOCK_MONOTONIC, &t[3]);
+        int won = valid && check_win(game, row, col);
+        int drawn = valid && !won && check_draw(game);
+        clock_gettime(CLOCK_MONOTONIC, &t[4]);
+
+        if (!valid || result != REPLAY_ONGOING) {
+            return 0;
+        }
+
+        for (int phase = 0; phase < NUM_PHASES; phase++) {
+            ns[phase] = ns_between(&t[phase], &t[phase + 1]);
+            if (phase == PHASE_ENGINE && !decide) {
+                continue;
+            }
+            if (!add_sample(&samples[phase], ns[phase])) {
+                return -1;
+            }
+            if (csv) {
+                fprintf(csv, "%s,%d,%d,%lld\n", phase_names[phase], index, m, ns[phase]);
+            }
+        }
+
+        if (won) result = game->current_player;
+        else if (drawn) result = REPLAY_DRAW;
+        else game->current_player = (game->current_player + 1) % game->num_players;
+    }
+
+    return result == rec->result;
+}
+
+
+static int compare_ns(const void *a, const void *b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+
+//Print count, mean, percentiles and maximum of one phase in microseconds
+
+static void print_distribution(const char *name, Samples *samples) {
+    if (samples->count == 0) {
+        return;
+    }
+
+    qsort(samples->values, samples->count, sizeof(long long), compare_ns);
+    double sum = 0;
+    for (size_t i = 0; i < samples->count; i++) {
+        sum += samples->values[i];
+    }
+
+    // Nearest rank, ceil(q * count), so the tail percentiles of a short run
+    // reach its slowest samples instead of rounding down past them
+    static const size_t per_mille[] = {500, 900, 990, 999};
+    printf("%-10s %9zu %10.3f", name, samples->count, sum / samples->count / 1e3);
+    for (int q = 0; q < 4; q++) {
+        size_t rank = (per_mille[q] * samples->count + 999) / 1000;
+        printf(" %10.3f", samples->values[rank ? rank - 1 : 0] / 1e3);
+    }
+    printf(" %10.3f\n", samples->values[samples->count - 1] / 1e3);
+}
+
+
+//Median cost of the clock reads around a phase, included in every sample
+
+static long long timer_overhead(void) {
+    long long values[1001];
+    struct timespec a, b;
+
+    for (int i = 0; i < 1001; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &a);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        values[i] = ns_between(&a, &b);
+    }
+    qsort(values, 1001, sizeof(long long), compare_ns);
+    return values[500];
+}
+
+
+static int parse_args(Options *opt, int argc, char **argv, int *first_file) {
+    opt->depth = 3;
+    opt->think_ms = 0;
+    opt->solve_empty = SOLVER_EMPTY_CELLS;
+    opt->runs = 1;
+    opt->csv_path = NULL;
+
+    int i = 1;
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+        const char *arg = argv[i];
+        if (i + 1 == argc) {
+            printf("Missing value for %s\n", arg);
+            return 0;
+        }
+        const char *value = argv[i + 1];
+
+        if (strcmp(arg, "--depth") == 0) opt->depth = atoi(value);
+        else if (strcmp(arg, "--think") == 0) opt->think_ms = atoi(value);
+        else if (strcmp(arg, "--solve") == 0) opt->solve_empty = atoi(value);
+        else if (strcmp(arg, "--runs") == 0) opt->runs = atoi(value);
+        else if (strcmp(arg, "--csv") == 0) opt->csv_path = value;
+        else {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+    }
+
+    if (opt->depth < 0 || opt->think_ms < 0 || opt->solve_empty < 0 || opt->runs < 1) {
+        printf("Usage: replay [--depth D] [--think MS] [--solve N] [--runs N] [--csv FILE] [FILE...]\n");
+        return 0;
+    }
+    *first_file = i;
+    return 1;
+}
+
+
+int main(int argc, char **argv) {
+    Options opt;
+    int first_file;
+    RecordingList list = {NULL, 0, 0};
+    Game *games[MAX_SIZE + 1][MAX_PLAYERS + 1] = {{NULL}};
+    Samples samples[NUM_PHASES];
+    long long agreed = 0, decisions = 0;
+    int mismatches = 0, status = 0;
+
+    if (!parse_args(&opt, argc, argv, &first_file)) {
+        return 1;
+    }
+
+    if (first_file == argc) {
+        status = !read_file(&list, LOG_FILE, games);
+    }
+    for (int i = first_file; i < argc && !status; i++) {
+        status = !read_file(&list, argv[i], games);
+    }
+    if (status || list.count == 0) {
+        if (!status) printf("No games to replay\n");
+        return 1;
+    }
+
+    FILE *csv = NULL;
+    if (opt.csv_path) {
+        csv = fopen(opt.csv_path, "w");
+        if (!csv) {
+            printf("Could not create '%s'\n", opt.csv_path);
+            return 1;
+        }
+        fprintf(csv, "phase,game,move,ns\n");
+    }
+
+    memset(samples, 0, sizeof(samples));
+    long long overhead = timer_overhead();
+    long long moves = 0;
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    for (int run = 0; run < opt.runs && !status; run++) {
+        for (int g = 0; g < list.count; g++) {
+            const Recording *rec = &list.games[g];
+            Game *game = board_game(games, rec->size, rec->num_players);
+            int matched = game ? replay_game(game, rec, g, &opt, samples, csv, &agreed, &decisions) : -1;
+            if (matched < 0) {
+                status = 1;
+                break;
+            }
+            if (!matched) {
+                if (run == 0) printf("Game %d: replayed result differs from the recorded one\n", g + 1);
+                mismatches++;
+            }
+            moves += rec->num_moves;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    printf("Replayed %d game%s, %lld moves (%d run%s) in %.2f s, %d result mismatch%s\n",
+           list.count, list.count == 1 ? "" : "s", moves, opt.runs, opt.runs == 1 ? "" : "s",
+           ns_between(&started, &finished) / 1e9, mismatches, mismatches == 1 ? "" : "es");
+    if (decisions > 0) {
+        printf("Engine (%s %d) chose the recorded move %.1f%% of the time\n",
+               opt.think_ms > 0 ? "think ms" : "depth", opt.think_ms > 0 ? opt.think_ms : opt.depth,
+               100.0 * agreed / decisions);
+    }
+
+    printf("\n%-10s %9s %10s %10s %10s %10s %10s %10s\n", "Phase (us)", "Samples", "Mean",
+           "p50", "p90", "p99", "p99.9", "Max");
+    for (int phase = 0; phase < NUM_PHASES; phase++) {
+        print_distribution(phase_names[phase], &samples[phase]);
+        free(samples[phase].values);
+    }
+    printf("Timer overhead: %lld ns per sample, included above\n", overhead);
+
+    if (csv) fclose(csv);
+    for (int size = 0; size <= MAX_SIZE; size++) {
+        for (int np = 0; np <= MAX_PLAYERS; np++) {
+            if (games[size][np]) cleanup_game(games[size][np]);
+        }
+    }
+    free(list.games);
+
+    return status || mismatches ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xoshiro256** generator state, one per game or thread
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+// Function prototypes
+uint64_t rng_time_seed(void);
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+uint64_t rng_next(Rng *rng);
+uint32_t rng_below(Rng *rng, uint32_t bound);
+
+
+#endif
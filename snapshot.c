@@ -0,0 +1,263 @@
+#include "snapshot.h"
+
+// Layout: "TTTS", version, size, players, current player, seed and the four
+// RNG state words (uint64 little-endian), then per player symbol, type,
+// strategy, search depth, think time (int32 little-endian), name length and
+// name, then the move count and one cell index per move, the board at 2 bits
+// per cell (0 empty, else player index + 1) and a 32-bit FNV-1a checksum of
+// everything before it
+#define HEADER_BYTES 48
+
+
+//FNV-1a over the snapshot bytes
+
+static uint32_t checksum(const unsigned char *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void put_u64(unsigned char *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_u64(const unsigned char *in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+
+//Encode a game, returns the number of bytes written or 0 if buf is too small
+
+size_t snapshot_pack(const Game *game, unsigned char *buf, size_t cap) {
+    int size = game->size;
+    int cells = size * size;
+    unsigned char out[SNAPSHOT_MAX_BYTES];
+    size_t n = 0;
+
+    memcpy(out, SNAPSHOT_MAGIC, 4);
+    out[4] = SNAPSHOT_VERSION;
+    out[5] = (unsigned char)size;
+    out[6] = (unsigned char)game->num_players;
+    out[7] = (unsigned char)game->current_player;
+    put_u64(out + 8, game->seed);
+    for (int i = 0; i < 4; i++) {
+        put_u64(out + 16 + 8 * i, game->rng.s[i]);
+    }
+    n = HEADER_BYTES;
+
+    for (int p = 0; p < game->num_players; p++) {
+        const Player *player = &game->players[p];
+        size_t len = strnlen(player->name, sizeof(player->name) - 1);
+        out[n++] = (unsigned char)player->symbol;
+        out[n++] = (unsigned char)player->type;
+        out[n++] = (unsigned char)player->strategy;
+        out[n++] = (unsigned char)player->max_depth;
+        for (int i = 0; i < 4; i++) {
+            out[n++] = (unsigned char)((uint32_t)player->think_ms >> (8 * i));
+        }
+        out[n++] = (unsigned char)len;
+        memcpy(out + n, player->name, len);
+        n += len;
+    }
+
+    out[n++] = (unsigned char)game->num_moves;
+    memcpy(out + n, game->moves, game->num_moves);
+    n += game->num_moves;
+
+    // Board, four cells per byte
+    memset(out + n, 0, (cells + 3) / 4);
+    for (int cell = 0; cell < cells; cell++) {
+        char symbol = game->board[cell / size][cell % size];
+        for (int p = 0; p < game->num_players; p++) {
+            if (symbol == game->players[p].symbol) {
+                out[n + cell / 4] |= (unsigned char)((p + 1) << (2 * (cell % 4)));
+            }
+        }
+    }
+    n += (cells + 3) / 4;
+
+    uint32_t sum = checksum(out, n);
+    for (int i = 0; i < 4; i++) {
+        out[n++] = (unsigned char)(sum >> (8 * i));
+    }
+
+    if (n > cap) {
+        return 0;
+    }
+    memcpy(buf, out, n);
+    return n;
+}
+
+
+//Check the header and checksum, returns 0 if this is not a valid snapshot
+
+int snapshot_peek(const unsigned char *buf, size_t len, int *size, int *num_players) {
+    if (len < HEADER_BYTES + 4 || memcmp(buf, SNAPSHOT_MAGIC, 4) != 0 || buf[4] != SNAPSHOT_VERSION ||
+        buf[5] < MIN_SIZE || buf[5] > MAX_SIZE || buf[6] < 2 || buf[6] > MAX_PLAYERS || buf[7] >= buf[6]) {
+        return 0;
+    }
+
+    const unsigned char *tail = buf + len - 4;
+    uint32_t sum = (uint32_t)tail[0] | (uint32_t)tail[1] << 8 | (uint32_t)tail[2] << 16 | (uint32_t)tail[3] << 24;
+    if (checksum(buf, len - 4) != sum) {
+        return 0;
+    }
+
+    *size = buf[5];
+    *num_players = buf[6];
+    return 1;
+}
+
+
+//Restore a snapshot into a game of the same board size and player count,
+//the game is left untouched if the snapshot is invalid or does not fit
+
+int snapshot_unpack(Game *game, const unsigned char *buf, size_t len) {
+    int size, num_players;
+    if (!snapshot_peek(buf, len, &size, &num_players) ||
+        size != game->size || num_players != game->num_players) {
+        return 0;
+    }
+
+    int cells = size * size;
+    const unsigned char *end = buf + len - 4;
+    const unsigned char *in = buf + HEADER_BYTES;
+    Player players[MAX_PLAYERS];
+
+    memset(players, 0, sizeof(players));
+    for (int p = 0; p < num_players; p++) {
+        if (end - in < 9 || in[1] > COMPUTER || in[2] > STRATEGY_SEARCH || in[8] >= sizeof(players[p].name) ||
+            end - in < 9 + in[8]) {
+            return 0;
+        }
+        players[p].symbol = (char)in[0];
+        players[p].type = (PlayerType)in[1];
+        players[p].strategy = (Strategy)in[2];
+        players[p].max_depth = in[3];
+        players[p].think_ms = (int32_t)((uint32_t)in[4] | (uint32_t)in[5] << 8 | (uint32_t)in[6] << 16 |
+                                        (uint32_t)in[7] << 24);
+        memcpy(players[p].name, in + 9, in[8]);
+        in += 9 + in[8];
+    }
+
+    if (end - in < 1 || in[0] > cells || end - in != 1 + in[0] + (cells + 3) / 4) {
+        return 0;
+    }
+    int num_moves = in[0];
+    const unsigned char *moves = in + 1;
+    const unsigned char *board = moves + num_moves;
+
+    // The board must be exactly the position reached by the move history
+    int occupied = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        int owner = (board[cell / 4] >> (2 * (cell % 4))) & 3;
+        if (owner > num_players) return 0;
+        occupied += owner > 0;
+    }
+    for (int i = 0; i < num_moves; i++) {
+        if (moves[i] >= cells || ((board[moves[i] / 4] >> (2 * (moves[i] % 4))) & 3) != i % num_players + 1) {
+            return 0;
+        }
+    }
+    if (occupied != num_moves) {
+        return 0;
+    }
+
+    memcpy(game->players, players, sizeof(players));
+    game->current_player = buf[7];
+    game->seed = get_u64(buf + 8);
+    for (int i = 0; i < 4; i++) {
+        game->rng.s[i] = get_u64(buf + 16 + 8 * i);
+    }
+    game->num_moves = num_moves;
+    memcpy(game->moves, moves, num_moves);
+    for (int cell = 0; cell < cells; cell++) {
+        int owner = (board[cell / 4] >> (2 * (cell % 4))) & 3;
+        game->board[cell / size][cell % size] = owner ? players[owner - 1].symbol : ' ';
+    }
+
+    return 1;
+}
+
+
+//Write a snapshot file (through a temporary file, so a crash never leaves half of one)
+
+int snapshot_save(const Game *game, const char *path) {
+    unsigned char buf[SNAPSHOT_MAX_BYTES];
+    char tmp_name[256];
+
+    size_t len = snapshot_pack(game, buf, sizeof(buf));
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", path);
+
+    FILE *file = fopen(tmp_name, "wb");
+    if (!file) {
+        return 0;
+    }
+    int ok = fwrite(buf, 1, len, file) == len;
+    ok = fclose(file) == 0 && ok;
+
+    return ok && rename(tmp_name, path) == 0;
+}
+
+
+//Read a snapshot file, returns its length or 0 if it is missing or invalid
+
+static size_t read_snapshot(const char *path, unsigned char *buf, int *size, int *num_players) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    size_t len = fread(buf, 1, SNAPSHOT_MAX_BYTES, file);
+    fclose(file);
+
+    return snapshot_peek(buf, len, size, num_players) ? len : 0;
+}
+
+
+//Board size and player count of a saved game, returns 0 if there is none
+
+int snapshot_info(const char *path, int *size, int *num_players) {
+    unsigned char buf[SNAPSHOT_MAX_BYTES];
+    return read_snapshot(path, buf, size, num_players) != 0;
+}
+
+
+//Start a new game session from a snapshot file; the log (log_path as for
+//initialize_game) is appended to, so the interrupted part is kept
+
+Game* snapshot_load(const char *path, const char *log_path) {
+    unsigned char buf[SNAPSHOT_MAX_BYTES];
+    int size, num_players;
+
+    size_t len = read_snapshot(path, buf, &size, &num_players);
+    if (!len) {
+        return NULL;
+    }
+
+    Game *game = initialize_game(size, num_players, get_u64(buf + 8), NULL);
+    if (!game) {
+        return NULL;
+    }
+    if (!snapshot_unpack(game, buf, len)) {
+        printf("Warning: '%s' is not a valid snapshot.\n", path);
+        cleanup_game(game);
+        return NULL;
+    }
+    open_game_log(game, log_path, "a");
+
+    if (game->log_file) {
+        fprintf(game->log_file, "Resumed after %d moves\n", game->num_moves);
+        log_game_state(game);
+        fflush(game->log_file);
+    }
+
+    return game;
+}
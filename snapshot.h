@@ -0,0 +1,21 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "tictactoe.h"
+
+// Constants
+#define SNAPSHOT_FILE "game_snapshot.bin"
+#define SNAPSHOT_MAGIC "TTTS"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_MAX_BYTES 512
+
+// Function prototypes
+size_t snapshot_pack(const Game *game, unsigned char *buf, size_t cap);
+int snapshot_peek(const unsigned char *buf, size_t len, int *size, int *num_players);
+int snapshot_unpack(Game *game, const unsigned char *buf, size_t len);
+int snapshot_save(const Game *game, const char *path);
+int snapshot_info(const char *path, int *size, int *num_players);
+Game* snapshot_load(const char *path, const char *log_path);
+
+
+#endif
@@ -0,0 +1,138 @@
+#include "solver.h"
+#include "order.h"
+
+
+//Find a cell that completes a line for the side to move, -1 if there is none
+
+static int winning_move(Engine *engine, const Position *pos) {
+    int p = pos->to_move;
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        if (pos->line_count[line][p] != pos->size - 1) {
+            continue;
+        }
+        for (int k = 0; k < pos->size; k++) {
+            int cell = engine->line_cells[line][k];
+            if (!pos->cells[cell]) {
+                return cell;
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+//Exact value for the root player (1 win, 0 draw, -1 loss), everyone else against it
+
+static int solve(Engine *engine, Position *pos, int root, int ply, int alpha, int beta) {
+    engine->nodes++;
+    if (engine_should_stop(engine) || pos->empty == 0) {
+        return 0;
+    }
+
+    int maximizing = pos->to_move == root;
+    uint64_t key = pos->hash ^ engine->zobrist_root[root];
+
+    int cell = winning_move(engine, pos);
+    if (cell >= 0) {
+        int value = maximizing ? 1 : -1;
+        tt_store(&engine->solved, key, value, pos->empty, TT_EXACT, cell);
+        return value;
+    }
+
+    int cached_move = -1;
+    TTEntry entry;
+    if (tt_probe(&engine->solved, key, &entry)) {
+        cached_move = entry.move;
+        if (entry.flag == TT_EXACT) return entry.score;
+        if (entry.flag == TT_LOWER && entry.score >= beta) return entry.score;
+        if (entry.flag == TT_UPPER && entry.score <= alpha) return entry.score;
+    }
+
+    int orig_alpha = alpha, orig_beta = beta;
+    int best = maximizing ? -2 : 2;
+    int best_move = -1;
+    int moves[MAX_CELLS], scores[MAX_CELLS];
+    int count = order_moves(engine, pos, key, ply, cached_move, moves, scores);
+
+    for (int i = 0; i < count; i++) {
+        cell = order_next(moves, scores, count, i);
+
+        position_make(engine, pos, cell);
+        tt_prefetch(&engine->solved, pos->hash ^ engine->zobrist_root[root]);
+        int value = solve(engine, pos, root, ply + 1, alpha, beta);
+        position_unmake(engine, pos, cell);
+
+        if (engine_stopped(engine)) {
+            return 0;
+        }
+
+        if (maximizing ? value > best : value < best) {
+            best = value;
+            best_move = cell;
+        }
+        if (maximizing && best > alpha) alpha = best;
+        if (!maximizing && best < beta) beta = best;
+        if (alpha >= beta) {
+            order_cutoff(&engine->order, pos, ply, pos->empty, cell, i);
+            break;
+        }
+    }
+
+    int flag = TT_EXACT;
+    if (best <= orig_alpha) flag = TT_UPPER;
+    else if (best >= orig_beta) flag = TT_LOWER;
+    tt_store(&engine->solved, key, best, pos->empty, flag, best_move);
+
+    return best;
+}
+
+
+//Solve the position exactly, returns 0 if the deadline or a stop came first
+
+int solver_solve(Engine *engine, const Position *pos, int root, SearchResult *result) {
+    Position work = *pos;
+    int best = -2, best_eval = 0, best_move = -1;
+
+    if (pos->to_move != root || pos->empty == 0) {
+        return 0;
+    }
+
+    // Value every root move; among equal ones prefer the best evaluation, so a
+    // drawn or lost position still sets the opponents as many problems as possible
+    int cell = winning_move(engine, &work);
+    if (cell >= 0) {
+        best = 1;
+        best_move = cell;
+    }
+
+    int moves[MAX_CELLS], scores[MAX_CELLS];
+    int count = order_moves(engine, &work, pos->hash ^ engine->zobrist_root[root], 0, -1, moves, scores);
+
+    for (int i = 0; i < count && best < 1; i++) {
+        cell = order_next(moves, scores, count, i);
+
+        position_make(engine, &work, cell);
+        int value = solve(engine, &work, root, 1, best - 1, 2);
+        int eval = engine_evaluate(engine, &work, root);
+        position_unmake(engine, &work, cell);
+
+        if (engine_stopped(engine)) {
+            return 0;
+        }
+
+        if (value > best || (value == best && eval > best_eval)) {
+            best = value;
+            best_eval = eval;
+            best_move = cell;
+        }
+    }
+
+    result->move = best_move;
+    result->score = best > 0 ? WIN_SCORE - 1 : (best < 0 ? -WIN_SCORE + 1 : 0);
+    result->depth = pos->empty;
+    result->pv[0] = best_move;
+    result->pv_len = 1;
+    return 1;
+}
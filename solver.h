@@ -0,0 +1,10 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "engine.h"
+
+// Function prototypes
+int solver_solve(Engine *engine, const Position *pos, int root, SearchResult *result);
+
+
+#endif
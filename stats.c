@@ -0,0 +1,207 @@
+#include "stats.h"
+
+#ifndef NO_STATS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+_Thread_local StatsShard *stats_shard = NULL;
+
+static StatsShard *shards = NULL;
+static pthread_mutex_t shards_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t shard_key;
+static struct timespec started;
+static struct timespec last_dump;
+static char export_path[STATS_PATH_LEN];
+
+static const char *latency_labels[LATENCY_KINDS] = {"human", "computer"};
+
+
+//Hand a thread's shard back for reuse when the thread exits
+
+static void release_shard(void *arg) {
+    StatsShard *shard = (StatsShard*)arg;
+    pthread_mutex_lock(&shards_lock);
+    shard->in_use = 0;
+    pthread_mutex_unlock(&shards_lock);
+}
+
+static void stats_setup(void) {
+    pthread_key_create(&shard_key, release_shard);
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    last_dump = started;
+}
+
+
+//Give the calling thread its own shard, reusing one left by a finished thread
+
+StatsShard* stats_register(void) {
+    static StatsShard fallback;
+    StatsShard *shard;
+
+    pthread_once(&stats_once, stats_setup);
+
+    pthread_mutex_lock(&shards_lock);
+    for (shard = shards; shard && shard->in_use; shard = shard->next);
+    if (!shard) {
+        shard = (StatsShard*)calloc(1, sizeof(StatsShard));
+        if (!shard) {
+            pthread_mutex_unlock(&shards_lock);
+            return &fallback; // Counts may be lost, but never crash over metrics
+        }
+        shard->next = shards;
+        shards = shard;
+    }
+    shard->in_use = 1;
+    pthread_mutex_unlock(&shards_lock);
+
+    pthread_setspecific(shard_key, shard);
+    stats_shard = shard;
+    return shard;
+}
+
+
+//Microseconds elapsed since a monotonic time stamp
+
+uint64_t stats_usec_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t usec = (int64_t)(now.tv_sec - start->tv_sec) * 1000000 +
+                   (now.tv_nsec - start->tv_nsec) / 1000;
+    return usec > 0 ? (uint64_t)usec : 0;
+}
+
+
+//Log-linear bucket: exact below 8us, then 4 buckets per power of two
+
+static int bucket_index(uint64_t usec) {
+    if (usec < 8) {
+        return (int)usec;
+    }
+
+    int msb = 63 - __builtin_clzll(usec);
+    int index = 8 + (msb - 3) * 4 + (int)((usec >> (msb - 2)) & 3);
+    return index < STATS_BUCKETS ? index : STATS_BUCKETS - 1;
+}
+
+static uint64_t bucket_upper(int index) {
+    if (index < 8) {
+        return (uint64_t)index;
+    }
+
+    int msb = 3 + (index - 8) / 4;
+    int sub = (index - 8) % 4;
+    return ((uint64_t)(4 + sub + 1) << (msb - 2)) - 1;
+}
+
+
+//Add one latency sample to the calling thread's histogram
+
+void stats_record_latency(LatencyKind kind, uint64_t usec) {
+    StatsShard *shard = stats_local();
+    stats_add(&shard->latency[kind][bucket_index(usec)], 1);
+    stats_add(&shard->latency_sum[kind], usec);
+}
+
+
+//Set the file stats_dump writes, NULL turns the export off (the default);
+//call before any other thread starts recording
+
+void stats_set_path(const char *path) {
+    snprintf(export_path, sizeof(export_path), "%s", path ? path : "");
+}
+
+
+//Write the stats file if the export interval has passed
+
+void stats_tick(void) {
+    pthread_once(&stats_once, stats_setup);
+    if (export_path[0] && stats_usec_since(&last_dump) >= (uint64_t)STATS_INTERVAL_SEC * 1000000) {
+        stats_dump();
+    }
+}
+
+
+//Sum one counter over every shard
+
+#define SUM_SHARDS(expr) do { \
+        total = 0; \
+        for (StatsShard *s = shards; s; s = s->next) total += atomic_load_explicit(&s->expr, memory_order_relaxed); \
+    } while (0)
+
+static void write_counter(FILE *file, const char *name, const char *help, uint64_t value) {
+    fprintf(file, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+            name, help, name, name, (unsigned long long)value);
+}
+
+
+//Write every metric in Prometheus text format to the export file, replacing it atomically
+
+void stats_dump(void) {
+    char tmp_name[STATS_PATH_LEN + 4];
+    uint64_t total;
+
+    pthread_once(&stats_once, stats_setup);
+    if (!export_path[0]) {
+        return;
+    }
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", export_path);
+
+    FILE *file = fopen(tmp_name, "w");
+    if (!file) {
+        return;
+    }
+
+    pthread_mutex_lock(&shards_lock);
+
+    SUM_SHARDS(games);
+    write_counter(file, "ttt_games_total", "Games played to a result.", total);
+    SUM_SHARDS(moves);
+    write_counter(file, "ttt_moves_total", "Moves played.", total);
+    SUM_SHARDS(search_nodes);
+    write_counter(file, "ttt_search_nodes_total", "Positions visited by the search engine.", total);
+    SUM_SHARDS(search_usec);
+    fprintf(file, "# HELP ttt_search_seconds_total Time spent searching.\n"
+                  "# TYPE ttt_search_seconds_total counter\nttt_search_seconds_total %.6f\n",
+            total / 1e6);
+    SUM_SHARDS(tt_probes);
+    write_counter(file, "ttt_tt_probes_total", "Transposition table lookups.", total);
+    SUM_SHARDS(tt_hits);
+    write_counter(file, "ttt_tt_hits_total", "Transposition table lookups that found the position.", total);
+    SUM_SHARDS(log_bytes);
+    write_counter(file, "ttt_log_bytes_total", "Bytes written to game logs.", total);
+    SUM_SHARDS(allocations);
+    write_counter(file, "ttt_allocations_total", "Heap allocations made by the game.", total);
+
+    fprintf(file, "# HELP ttt_move_latency_seconds Time taken to produce a move.\n"
+                  "# TYPE ttt_move_latency_seconds histogram\n");
+    for (int kind = 0; kind < LATENCY_KINDS; kind++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            SUM_SHARDS(latency[kind][b]);
+            cumulative += total;
+            fprintf(file, "ttt_move_latency_seconds_bucket{player=\"%s\",le=\"%.6f\"} %llu\n",
+                    latency_labels[kind], (bucket_upper(b) + 1) / 1e6, (unsigned long long)cumulative);
+        }
+        fprintf(file, "ttt_move_latency_seconds_bucket{player=\"%s\",le=\"+Inf\"} %llu\n",
+                latency_labels[kind], (unsigned long long)cumulative);
+        SUM_SHARDS(latency_sum[kind]);
+        fprintf(file, "ttt_move_latency_seconds_sum{player=\"%s\"} %.6f\n", latency_labels[kind], total / 1e6);
+        fprintf(file, "ttt_move_latency_seconds_count{player=\"%s\"} %llu\n",
+                latency_labels[kind], (unsigned long long)cumulative);
+    }
+
+    pthread_mutex_unlock(&shards_lock);
+
+    fprintf(file, "# HELP ttt_uptime_seconds Seconds since the process started.\n"
+                  "# TYPE ttt_uptime_seconds gauge\nttt_uptime_seconds %.3f\n",
+            stats_usec_since(&started) / 1e6);
+    fclose(file);
+
+    rename(tmp_name, export_path);
+    clock_gettime(CLOCK_MONOTONIC, &last_dump);
+}
+
+#endif
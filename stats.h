@@ -0,0 +1,82 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// Constants (STATS_FILE is the front end's default, other programs export nothing)
+#define STATS_FILE "game_stats.prom"
+#define STATS_PATH_LEN 256
+#define STATS_INTERVAL_SEC 10
+#define STATS_BUCKETS 136
+
+// Latency histogram kinds
+typedef enum {
+    LATENCY_HUMAN_MOVE,
+    LATENCY_COMPUTER_MOVE,
+    LATENCY_KINDS
+} LatencyKind;
+
+// Counters owned by one thread (written by that thread only, read by the exporter)
+typedef struct StatsShard {
+    _Atomic uint64_t games;
+    _Atomic uint64_t moves;
+    _Atomic uint64_t search_nodes;
+    _Atomic uint64_t search_usec;
+    _Atomic uint64_t tt_probes;
+    _Atomic uint64_t tt_hits;
+    _Atomic uint64_t log_bytes;
+    _Atomic uint64_t allocations;
+    _Atomic uint64_t latency[LATENCY_KINDS][STATS_BUCKETS];
+    _Atomic uint64_t latency_sum[LATENCY_KINDS];
+    int in_use;
+    struct StatsShard *next;
+} StatsShard;
+
+#ifndef NO_STATS
+
+extern _Thread_local StatsShard *stats_shard;
+
+// Function prototypes
+StatsShard* stats_register(void);
+void stats_record_latency(LatencyKind kind, uint64_t usec);
+uint64_t stats_usec_since(const struct timespec *start);
+void stats_set_path(const char *path);
+void stats_tick(void);
+void stats_dump(void);
+
+// Single-writer increment: a plain load and store, no locked instruction
+static inline void stats_add(_Atomic uint64_t *counter, uint64_t n) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+static inline StatsShard* stats_local(void) {
+    return stats_shard ? stats_shard : stats_register();
+}
+
+#define STATS_ADD(field, n) stats_add(&stats_local()->field, (uint64_t)(n))
+#define STATS_INC(field) STATS_ADD(field, 1)
+#define STATS_TIMER(name) struct timespec name; clock_gettime(CLOCK_MONOTONIC, &name)
+#define STATS_ADD_ELAPSED(field, name) STATS_ADD(field, stats_usec_since(&name))
+#define STATS_LATENCY(kind, name) stats_record_latency(kind, stats_usec_since(&name))
+#define STATS_TICK() stats_tick()
+#define STATS_DUMP() stats_dump()
+#define STATS_EXPORT(path) stats_set_path(path)
+
+#else
+
+#define STATS_ADD(field, n) ((void)sizeof(n))
+#define STATS_INC(field) ((void)0)
+#define STATS_TIMER(name) ((void)0)
+#define STATS_ADD_ELAPSED(field, name) ((void)0)
+#define STATS_LATENCY(kind, name) ((void)0)
+#define STATS_TICK() ((void)0)
+#define STATS_DUMP() ((void)0)
+#define STATS_EXPORT(path) ((void)(path))
+
+#endif
+
+
+#endif
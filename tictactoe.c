@@ -1,9 +1,14 @@
 #include "tictactoe.h"
+#include "engine.h"
+#include "eval.h"
+#include "ponder.h"
+#include "snapshot.h"
+#include "stats.h"
 
 
 //Initialize the game with dynamic memory allocation
 
-Game* initialize_game(int size, int num_players) {
+Game* initialize_game(int size, int num_players, uint64_t seed, const char *log_path) {
     Game *game = (Game*)malloc(sizeof(Game));
     if (!game) {
         printf("Memory allocation failed!\n");
@@ -37,56 +42,95 @@ Game* initialize_game(int size, int num_players) {
         }
     }
 
+    STATS_ADD(allocations, 2 + size);
+
     game->size = size;
     game->num_players = num_players;
     game->current_player = 0;
+    game->num_moves = 0;
 
-    // Open log file
-    game->log_file = fopen(LOG_FILE, "w");
-    if (!game->log_file) {
-        printf("Warning: Could not create log file.\n");
+    // Every game has its own random stream so it can be replayed from the seed
+    game->seed = seed;
+    rng_seed(&game->rng, seed, 0);
+
+    game->snapshot_path[0] = '\0';
+
+    // Open log file (no log_path means logging is off)
+    open_game_log(game, log_path, "w");
+
+    // Search engine for computer players (random moves if unavailable)
+    game->engine = engine_create(size, num_players, ENGINE_TT_MB);
+    if (!game->engine) {
+        printf("Warning: Could not create search engine, computer will play randomly.\n");
     } else {
-        fprintf(game->log_file, "=== NEW TIC-TAC-TOE GAME ===\n");
-        fprintf(game->log_file, "Board Size: %dx%d\n", size, size);
-        fprintf(game->log_file, "Number of Players: %d\n", num_players);
-        fprintf(game->log_file, "============================\n\n");
+        // Learned evaluation if a weights file for this board is present
+        char eval_file[64];
+        eval_file_name(eval_file, sizeof(eval_file), size, num_players);
+        eval_load(game->engine, eval_file);
     }
 
     return game;
 }
 
 
-//Setup players based on game mode
- 
-void setup_players(Game *game) {
+//Open the log file with the given fopen mode and write the game header
+//(no log_path means logging is off)
+
+void open_game_log(Game *game, const char *log_path, const char *mode) {
+    game->log_file = log_path ? fopen(log_path, mode) : NULL;
+    if (!game->log_file) {
+        if (log_path) printf("Warning: Could not create log file.\n");
+        return;
+    }
+
+    fprintf(game->log_file, "=== NEW TIC-TAC-TOE GAME ===\n");
+    fprintf(game->log_file, "Board Size: %dx%d\n", game->size, game->size);
+    fprintf(game->log_file, "Number of Players: %d\n", game->num_players);
+    fprintf(game->log_file, "Seed: %llu\n", (unsigned long long)game->seed);
+    fprintf(game->log_file, "============================\n\n");
+}
+
+
+//Setup players from the configured seats, asking for anything not given
+
+void setup_players(Game *game, const Config *config) {
     char symbols[] = {'X', 'O', 'Z'};
 
     for (int i = 0; i < game->num_players; i++) {
-        game->players[i].symbol = symbols[i];
-
-        if (game->num_players == 2 && i == 1) {
-            // Part 2: User vs Computer
-            game->players[i].type = COMPUTER;
-            strcpy(game->players[i].name, "Computer");
-        } else if (game->num_players == 3 && i > 0) {
-            // Part 3: Multi-player (at least one human)
+        const SeatConfig *seat = &config->seats[i];
+        Player *player = &game->players[i];
+        SeatType type = seat->type;
+
+        player->symbol = symbols[i];
+
+        if (type == SEAT_UNSET) {
             printf("Is Player %d human or computer? (h/c): ", i + 1);
             char choice;
             scanf(" %c", &choice);
+            type = (choice == 'h' || choice == 'H') ? SEAT_HUMAN : SEAT_COMPUTER;
+        }
 
-            if (choice == 'h' || choice == 'H') {
-                game->players[i].type = HUMAN;
-                printf("Enter name for Player %d: ", i + 1);
-                scanf("%s", game->players[i].name);
+        if (type == SEAT_HUMAN) {
+            player->type = HUMAN;
+            player->strategy = STRATEGY_RANDOM;
+            if (seat->name[0]) {
+                strcpy(player->name, seat->name);
             } else {
-                game->players[i].type = COMPUTER;
-                sprintf(game->players[i].name, "Computer_%d", i + 1);
+                printf("Enter name for Player %d: ", i + 1);
+                scanf("%49s", player->name);
             }
         } else {
-            // Human player
-            game->players[i].type = HUMAN;
-            printf("Enter name for Player %d: ", i + 1);
-            scanf("%s", game->players[i].name);
+            player->type = COMPUTER;
+            player->strategy = seat->random_play ? STRATEGY_RANDOM : STRATEGY_SEARCH;
+            player->max_depth = seat->depth;
+            player->think_ms = seat->think_ms;
+            if (seat->name[0]) {
+                strcpy(player->name, seat->name);
+            } else if (game->num_players == 2) {
+                strcpy(player->name, "Computer");
+            } else {
+                sprintf(player->name, "Computer_%d", i + 1);
+            }
         }
     }
 }
@@ -184,6 +228,7 @@ int make_move(Game *game, int row, int col) {
     }
 
     game->board[row][col] = game->players[game->current_player].symbol;
+    game->moves[game->num_moves++] = (unsigned char)(row * game->size + col);
     log_move(game, row, col);
     return 1;
 }
@@ -191,23 +236,56 @@ int make_move(Game *game, int row, int col) {
 
 //Generate computer move
  
-void computer_move(Game *game) {
-    int row, col;
+void computer_move(Game *game, int *row, int *col) {
+    Player *player = &game->players[game->current_player];
 
-    printf("\n%s is thinking...\n", game->players[game->current_player].name);
+    printf("\n%s is thinking...\n", player->name);
 
-    // Simple random strategy
-    do {
-        row = rand() % game->size;
-        col = rand() % game->size;
-    } while (game->board[row][col] != ' ');
+    if (player->strategy == STRATEGY_SEARCH && game->engine) {
+        Engine *engine = game->engine;
+        Position pos;
+        SearchResult result;
+        int cell;
 
-    game->board[row][col] = game->players[game->current_player].symbol;
+        position_from_game(engine, &pos, game);
+        engine->max_depth = player->max_depth;
 
-    printf("%s played at position (%d, %d)\n",
-           game->players[game->current_player].name, row + 1, col + 1);
+        // Reuse the pondered reply if there is one, the table is warm either way
+        if (ponder_hit(engine, &pos, game->current_player, &cell)) {
+            *row = cell / game->size;
+            *col = cell % game->size;
+        } else {
+            engine_search(engine, &pos, game->current_player,
+                          player->think_ms ? player->think_ms : engine->think_ms, &result);
+            *row = result.move / game->size;
+            *col = result.move % game->size;
+        }
+    } else {
+        // Simple random strategy: pick one of the empty cells uniformly
+        int empty = 0;
+        for (int i = 0; i < game->size; i++) {
+            for (int j = 0; j < game->size; j++) {
+                if (game->board[i][j] == ' ') empty++;
+            }
+        }
 
-    log_move(game, row, col);
+        int pick = (int)rng_below(&game->rng, (uint32_t)empty);
+        for (int i = 0; i < game->size && pick >= 0; i++) {
+            for (int j = 0; j < game->size && pick >= 0; j++) {
+                if (game->board[i][j] == ' ' && pick-- == 0) {
+                    *row = i;
+                    *col = j;
+                }
+            }
+        }
+    }
+
+    game->board[*row][*col] = player->symbol;
+    game->moves[game->num_moves++] = (unsigned char)(*row * game->size + *col);
+
+    printf("%s played at position (%d, %d)\n", player->name, *row + 1, *col + 1);
+
+    log_move(game, *row, *col);
 }
 
 
@@ -279,10 +357,11 @@ int check_draw(Game *game) {
  
 void log_move(Game *game, int row, int col) {
     if (game->log_file) {
-        fprintf(game->log_file, "Move: %s (%c) -> Position (%d, %d)\n",
-                game->players[game->current_player].name,
-                game->players[game->current_player].symbol,
-                row + 1, col + 1);
+        int written = fprintf(game->log_file, "Move: %s (%c) -> Position (%d, %d)\n",
+                              game->players[game->current_player].name,
+                              game->players[game->current_player].symbol,
+                              row + 1, col + 1);
+        STATS_ADD(log_bytes, written);
 
         log_game_state(game);
         fflush(game->log_file);
@@ -295,15 +374,16 @@ void log_move(Game *game, int row, int col) {
 void log_game_state(Game *game) {
     if (!game->log_file) return;
 
-    fprintf(game->log_file, "Current Board State:\n");
+    int written = fprintf(game->log_file, "Current Board State:\n");
     for (int i = 0; i < game->size; i++) {
-        fprintf(game->log_file, "|");
+        written += fprintf(game->log_file, "|");
         for (int j = 0; j < game->size; j++) {
-            fprintf(game->log_file, " %c |", game->board[i][j]);
+            written += fprintf(game->log_file, " %c |", game->board[i][j]);
         }
-        fprintf(game->log_file, "\n");
+        written += fprintf(game->log_file, "\n");
     }
-    fprintf(game->log_file, "\n");
+    written += fprintf(game->log_file, "\n");
+    STATS_ADD(log_bytes, written);
 }
 
 
@@ -317,27 +397,26 @@ void play_game(Game *game) {
 
     while (!game_over) {
         display_board(game);
+        STATS_TIMER(turn_started);
 
         // Get move based on player type
         if (game->players[game->current_player].type == HUMAN) {
+            // Let the computer think about its reply while we wait for input
+            ponder_start(game->engine, game);
             do {
                 if (!get_user_move(game, &row, &col)) {
                     printf("Invalid input format! Please enter two numbers.\n");
                     continue;
                 }
             } while (!make_move(game, row, col));
+            ponder_stop(game->engine);
+            STATS_LATENCY(LATENCY_HUMAN_MOVE, turn_started);
         } else {
-            computer_move(game);
-            row = -1; col = -1; // Find the last move made by computer
-            for (int i = 0; i < game->size && row == -1; i++) {
-                for (int j = 0; j < game->size && col == -1; j++) {
-                    if (game->board[i][j] == game->players[game->current_player].symbol) {
-                        // This is a simple way to find last move, not perfect but works for demo
-                        row = i; col = j;
-                    }
-                }
-            }
+            computer_move(game, &row, &col);
+            STATS_LATENCY(LATENCY_COMPUTER_MOVE, turn_started);
         }
+        STATS_INC(moves);
+        STATS_TICK();
 
         // Check for win
         if (check_win(game, row, col)) {
@@ -362,9 +441,13 @@ void play_game(Game *game) {
             game_over = 1;
         }
 
-        // Move to next player
-        if (!game_over) {
+        // Move to next player, keeping a snapshot so an interrupted game can be resumed
+        if (game_over) {
+            STATS_INC(games);
+            if (game->snapshot_path[0]) remove(game->snapshot_path);
+        } else {
             game->current_player = (game->current_player + 1) % game->num_players;
+            if (game->snapshot_path[0]) snapshot_save(game, game->snapshot_path);
         }
     }
 }
@@ -390,6 +473,9 @@ void cleanup_game(Game *game) {
             fclose(game->log_file);
         }
 
+        ponder_stop(game->engine);
+        engine_destroy(game->engine);
+
         free(game);
     }
 }
@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include "rng.h"
+#include "config.h"
 
 // Constants
 #define MIN_SIZE 3
@@ -18,14 +20,26 @@ typedef enum {
     COMPUTER
 } PlayerType;
 
-// Player structure
+// Computer strategies
+typedef enum {
+    STRATEGY_RANDOM,
+    STRATEGY_SEARCH
+} Strategy;
+
+// Player structure (search limits: max_depth 0 is unlimited, think_ms 0 is the
+// engine's default and -1 searches to max_depth without a time limit)
 typedef struct {
     char symbol;
     PlayerType type;
+    Strategy strategy;
+    int max_depth;
+    int think_ms;
     char name[50];
 } Player;
 
-// Game structure
+struct Engine;
+
+// Game structure (an empty snapshot_path means no snapshot is kept)
 typedef struct {
     char **board;
     int size;
@@ -33,17 +47,24 @@ typedef struct {
     Player players[MAX_PLAYERS];
     int current_player;
     FILE *log_file;
+    struct Engine *engine;
+    uint64_t seed;
+    Rng rng;
+    unsigned char moves[MAX_SIZE * MAX_SIZE];
+    int num_moves;
+    char snapshot_path[CONFIG_PATH_LEN];
 } Game;
 
 // Function prototypes
-Game* initialize_game(int size, int num_players);
-void setup_players(Game *game);
+Game* initialize_game(int size, int num_players, uint64_t seed, const char *log_path);
+void open_game_log(Game *game, const char *log_path, const char *mode);
+void setup_players(Game *game, const Config *config);
 void display_board(Game *game);
 void display_instructions(Game *game);
 int get_user_move(Game *game, int *row, int *col);
 int validate_move(Game *game, int row, int col);
 int make_move(Game *game, int row, int col);
-void computer_move(Game *game);
+void computer_move(Game *game, int *row, int *col);
 int check_win(Game *game, int row, int col);
 int check_draw(Game *game);
 void log_move(Game *game, int row, int col);
@@ -0,0 +1,639 @@
+// Engine-vs-engine tournament runner (no interactive front end)
+//
+// Build: gcc -O2 -pthread tournament.c engine.c order.c eval.c solver.c tt.c rng.c stats.c -o tournament -lm
+// Usage: tournament [options]
+//   --engines LIST   comma separated: random, dN (search to depth N), tN (search N ms),
+//                    a search engine may add :FILE to use learned weights (e.g. d2:eval_4x4_2p.bin)
+//   --mode MODE      rr (round robin, default) or gauntlet (first engine vs the rest)
+//   --sizes LIST     board sizes, e.g. 3,4,5 (default 3)
+//   --players LIST   player counts, e.g. 2,3 (default 2)
+//   --games N        games per pairing, size and seat order (default 10)
+//   --no-rotate      do not rotate seats between engines
+//   --openings N     random plies at the start of every game (default 2)
+//   --threads N      worker threads (default: all cores)
+//   --seed S         master seed, game i uses stream i (default: from the clock)
+//   --hash MB        transposition table per engine, board and thread (default 4)
+//   --sprt E0,E1     stop a 2-player pairing once SPRT(E0, E1) decides (alpha = beta = 0.05)
+//   --solve N        solve exactly once N or fewer cells are empty (default 14, 0 to disable)
+//
+// Elo and SPRT come from the 2-player games only, 3-player games are reported
+// per engine as wins, draws and games won by another engine.
+
+#include <math.h>
+#include <unistd.h>
+#include "eval.h"
+
+#define MAX_ENGINES 16
+#define MAX_SIZES (MAX_SIZE - MIN_SIZE + 1)
+#define SPRT_ALPHA 0.05
+#define SPRT_BETA 0.05
+
+// One competitor
+typedef struct {
+    char name[80];
+    Strategy strategy;
+    int depth;
+    int think_ms;
+    char eval_file[64];
+} EngineSpec;
+
+// One game to play
+typedef struct {
+    int index;
+    int size;
+    int num_players;
+    int seats[MAX_PLAYERS];
+} Job;
+
+// Win/draw/loss counts of one engine against another
+typedef struct {
+    int wins;
+    int draws;
+    int losses;
+} Record;
+
+// Whole tournament, shared by the workers: records holds the 2-player games
+// by pairing, multi the 3-player games by engine (a loss is a game another
+// engine won), since one 3-player game is not a set of independent pairings
+typedef struct {
+    EngineSpec engines[MAX_ENGINES];
+    int num_engines;
+    int sizes[MAX_SIZES];
+    int num_sizes;
+    int player_counts[2];
+    int num_counts;
+    int games;
+    int rotate;
+    int gauntlet;
+    int openings;
+    int threads;
+    uint64_t seed;
+    size_t hash_mb;
+    int solve_empty;
+    int sprt;
+    double elo0, elo1;
+
+    Job *jobs;
+    int num_jobs;
+    atomic_int next_job;
+    atomic_int played;
+    atomic_int failed;
+
+    pthread_mutex_t lock;
+    Record records[MAX_ENGINES][MAX_ENGINES];
+    Record multi[MAX_ENGINES];
+    atomic_int decided[MAX_ENGINES][MAX_ENGINES];
+} Tournament;
+
+// Line tables and search engines for one board size and player count
+typedef struct {
+    Engine *tables;
+    Engine *engines[MAX_ENGINES];
+} EngineSet;
+
+// Engines owned by one worker thread, one set per board size and player
+// count, kept for the whole run since the schedule alternates between them
+typedef struct {
+    Tournament *t;
+    EngineSet sets[MAX_SIZE + 1][MAX_PLAYERS + 1];
+    Engine *tables;
+    Engine **engines;
+} Worker;
+
+
+//Parse an engine name like random, d4, t100 or d2:weights.bin
+
+static int parse_engine(char *text, EngineSpec *spec) {
+    memset(spec, 0, sizeof(EngineSpec));
+    snprintf(spec->name, sizeof(spec->name), "%s", text);
+
+    char *colon = strchr(text, ':');
+    if (colon) {
+        *colon = '\0';
+        snprintf(spec->eval_file, sizeof(spec->eval_file), "%s", colon + 1);
+    }
+
+    if (strcmp(text, "random") == 0) {
+        spec->strategy = STRATEGY_RANDOM;
+        return 1;
+    }
+
+    spec->strategy = STRATEGY_SEARCH;
+    spec->think_ms = -1;
+    if (text[0] == 'd' && atoi(text + 1) > 0) {
+        spec->depth = atoi(text + 1);
+        return 1;
+    }
+    if (text[0] == 't' && atoi(text + 1) > 0) {
+        spec->think_ms = atoi(text + 1);
+        return 1;
+    }
+
+    printf("Unknown engine '%s' (use random, dN or tN)\n", spec->name);
+    return 0;
+}
+
+
+//Parse a comma separated list of integers
+
+static int parse_list(char *text, int *values, int max, int low, int high) {
+    int count = 0;
+
+    for (char *item = strtok(text, ","); item; item = strtok(NULL, ",")) {
+        int value = atoi(item);
+        if (count == max || value < low || value > high) {
+            printf("Invalid value '%s' (expected %d-%d)\n", item, low, high);
+            return -1;
+        }
+        values[count++] = value;
+    }
+
+    return count;
+}
+
+
+//Append one game per seat rotation of a line-up
+
+static void add_lineup(Tournament *t, int size, int num_players, const int *lineup) {
+    int rotations = t->rotate ? num_players : 1;
+
+    for (int r = 0; r < rotations; r++) {
+        Job *job = &t->jobs[t->num_jobs];
+        job->index = t->num_jobs++;
+        job->size = size;
+        job->num_players = num_players;
+        for (int seat = 0; seat < num_players; seat++) {
+            job->seats[seat] = lineup[(seat + r) % num_players];
+        }
+    }
+}
+
+
+//Number of line-ups for one player count
+
+static long count_lineups(Tournament *t, int players) {
+    long n = t->gauntlet ? t->num_engines - 1 : t->num_engines;
+    long lineups = players == 2 ? n * (n - 1) / 2 : n * (n - 1) * (n - 2) / 6;
+
+    // A gauntlet line-up is the first engine plus players - 1 of the others
+    if (t->gauntlet) {
+        lineups = players == 2 ? n : n * (n - 1) / 2;
+    }
+    return lineups * (t->rotate ? players : 1);
+}
+
+
+//Build the schedule, repetitions outermost so early stopping sees every pairing
+
+static int build_jobs(Tournament *t) {
+    long max_jobs = 0;
+    for (int c = 0; c < t->num_counts; c++) {
+        max_jobs += count_lineups(t, t->player_counts[c]);
+    }
+    max_jobs *= (long)t->games * t->num_sizes;
+
+    if (max_jobs > 100000000L) {
+        printf("Too many games scheduled (%ld)\n", max_jobs);
+        return 0;
+    }
+
+    t->jobs = (Job*)malloc(max_jobs * sizeof(Job));
+    if (!t->jobs) {
+        printf("Memory allocation failed!\n");
+        return 0;
+    }
+    t->num_jobs = 0;
+
+    int n = t->num_engines;
+    for (int g = 0; g < t->games; g++) {
+        for (int s = 0; s < t->num_sizes; s++) {
+            for (int c = 0; c < t->num_counts; c++) {
+                int players = t->player_counts[c];
+
+                for (int a = 0; a < n; a++) {
+                    for (int b = a + 1; b < n; b++) {
+                        if (t->gauntlet && a != 0) continue;
+
+                        if (players == 2) {
+                            int lineup[2] = {a, b};
+                            add_lineup(t, t->sizes[s], players, lineup);
+                            continue;
+                        }
+
+                        for (int c3 = b + 1; c3 < n; c3++) {
+                            int lineup[3] = {a, b, c3};
+                            add_lineup(t, t->sizes[s], players, lineup);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return t->num_jobs > 0;
+}
+
+
+//Make sure the worker's engines match the board of the next game,
+//creating the set for a new board size and player count on first use
+
+static int prepare_worker(Worker *w, int size, int num_players) {
+    EngineSet *set = &w->sets[size][num_players];
+
+    if (!set->tables) {
+        // Line tables for playing moves, shared by every seat
+        set->tables = engine_create(size, num_players, 0);
+        if (!set->tables) {
+            return 0;
+        }
+
+        for (int e = 0; e < w->t->num_engines; e++) {
+            if (w->t->engines[e].strategy != STRATEGY_SEARCH) {
+                continue;
+            }
+            set->engines[e] = engine_create(size, num_players, w->t->hash_mb);
+            if (!set->engines[e]) {
+                return 0;
+            }
+            if (w->t->engines[e].eval_file[0] && !eval_load(set->engines[e], w->t->engines[e].eval_file)) {
+                printf("Could not load weights for %s\n", w->t->engines[e].name);
+                return 0;
+            }
+            set->engines[e]->max_depth = w->t->engines[e].depth;
+            set->engines[e]->solve_empty = w->t->solve_empty;
+        }
+    }
+
+    w->tables = set->tables;
+    w->engines = set->engines;
+    return 1;
+}
+
+
+//Play one game, returns the winning seat or -1 for a draw
+
+static int play_job(Worker *w, const Job *job) {
+    Tournament *t = w->t;
+    Position pos;
+    Rng rng;
+
+    rng_seed(&rng, t->seed, (uint64_t)job->index);
+    position_init(w->tables, &pos);
+
+    // Start every engine fresh, so a game does not depend on which worker played it
+    for (int seat = 0; seat < job->num_players; seat++) {
+        if (w->engines[job->seats[seat]]) {
+            engine_new_game(w->engines[job->seats[seat]]);
+        }
+    }
+
+    for (int ply = 0; pos.empty > 0; ply++) {
+        int seat = pos.to_move;
+        const EngineSpec *spec = &t->engines[job->seats[seat]];
+        int cell;
+
+        if (ply < t->openings || spec->strategy == STRATEGY_RANDOM) {
+            cell = position_random_move(&pos, &rng);
+        } else {
+            SearchResult result;
+            engine_search(w->engines[job->seats[seat]], &pos, seat, spec->think_ms, &result);
+            cell = result.move;
+        }
+
+        if (position_make(w->tables, &pos, cell)) {
+            return seat;
+        }
+    }
+
+    return -1;
+}
+
+
+//Log-likelihood ratio of elo1 against elo0 (trinomial approximation,
+//half a win and half a loss are added so one-sided results still converge)
+
+static double sprt_llr(const Record *r, double elo0, double elo1) {
+    double wins = r->wins + 0.5, draws = r->draws, losses = r->losses + 0.5;
+    double n = wins + draws + losses;
+
+    double score = (wins + 0.5 * draws) / n;
+    double var = (wins * (1 - score) * (1 - score) +
+                  draws * (0.5 - score) * (0.5 - score) +
+                  losses * score * score) / n;
+    double s0 = 1 / (1 + pow(10, -elo0 / 400));
+    double s1 = 1 / (1 + pow(10, -elo1 / 400));
+
+    return (s1 - s0) * (2 * score - s0 - s1) / (2 * var) * n;
+}
+
+
+//Record the outcome of a finished game
+
+static void record_result(Tournament *t, const Job *job, int winner) {
+    pthread_mutex_lock(&t->lock);
+
+    if (job->num_players > 2) {
+        for (int seat = 0; seat < job->num_players; seat++) {
+            Record *r = &t->multi[job->seats[seat]];
+            if (winner == seat) r->wins++;
+            else if (winner < 0) r->draws++;
+            else r->losses++;
+        }
+        pthread_mutex_unlock(&t->lock);
+        return;
+    }
+
+    for (int a = 0; a < 2; a++) {
+        Record *r = &t->records[job->seats[a]][job->seats[1 - a]];
+        if (winner == a) r->wins++;
+        else if (winner < 0) r->draws++;
+        else r->losses++;
+    }
+
+    // SPRT tests the lower numbered engine (the gauntlet candidate) against the other
+    if (t->sprt) {
+        int a = job->seats[0] < job->seats[1] ? job->seats[0] : job->seats[1];
+        int b = job->seats[0] + job->seats[1] - a;
+        double llr = sprt_llr(&t->records[a][b], t->elo0, t->elo1);
+        double upper = log((1 - SPRT_BETA) / SPRT_ALPHA);
+        double lower = log(SPRT_BETA / (1 - SPRT_ALPHA));
+
+        if (!atomic_load(&t->decided[a][b]) && (llr >= upper || llr <= lower)) {
+            const Record *r = &t->records[a][b];
+            atomic_store(&t->decided[a][b], 1);
+            atomic_store(&t->decided[b][a], 1);
+            printf("SPRT: %s vs %s decided after %d games: %s (LLR %.2f)\n",
+                   t->engines[a].name, t->engines[b].name,
+                   r->wins + r->draws + r->losses,
+                   llr >= upper ? "H1 accepted" : "H0 accepted", llr);
+        }
+    }
+
+    pthread_mutex_unlock(&t->lock);
+}
+
+
+//Worker thread: take games from the shared queue until it is empty
+
+static void* worker_thread(void *arg) {
+    Worker worker = {.t = (Tournament*)arg};
+    Tournament *t = worker.t;
+    int i;
+
+    while ((i = atomic_fetch_add(&t->next_job, 1)) < t->num_jobs) {
+        const Job *job = &t->jobs[i];
+
+        if (job->num_players == 2 && atomic_load(&t->decided[job->seats[0]][job->seats[1]])) {
+            continue;
+        }
+        if (!prepare_worker(&worker, job->size, job->num_players)) {
+            // A partial set of games would skew the report, stop everyone
+            printf("Could not set up engines for %dx%d with %d players\n",
+                   job->size, job->size, job->num_players);
+            atomic_store(&t->failed, 1);
+            atomic_store(&t->next_job, t->num_jobs);
+            break;
+        }
+
+        record_result(t, job, play_job(&worker, job));
+        atomic_fetch_add(&t->played, 1);
+    }
+
+    for (int size = MIN_SIZE; size <= MAX_SIZE; size++) {
+        for (int np = 2; np <= MAX_PLAYERS; np++) {
+            for (int e = 0; e < t->num_engines; e++) {
+                engine_destroy(worker.sets[size][np].engines[e]);
+            }
+            engine_destroy(worker.sets[size][np].tables);
+        }
+    }
+    return NULL;
+}
+
+
+//Elo difference for a score fraction, clamped away from 0 and 1
+
+static double elo_from_score(double score) {
+    if (score < 0.001) score = 0.001;
+    if (score > 0.999) score = 0.999;
+    return score == 0.5 ? 0 : -400 * log10(1 / score - 1);
+}
+
+
+//Elo with a 95% confidence interval from win/draw/loss counts
+
+static void print_elo(const Record *r) {
+    int n = r->wins + r->draws + r->losses;
+    if (n == 0) {
+        printf("%8s", "-");
+        return;
+    }
+
+    double score = (r->wins + 0.5 * r->draws) / n;
+    double var = (r->wins * (1 - score) * (1 - score) +
+                  r->draws * (0.5 - score) * (0.5 - score) +
+                  r->losses * score * score) / n;
+    double margin = 1.96 * sqrt(var / n);
+    double elo = elo_from_score(score);
+    double low = elo_from_score(score - margin);
+    double high = elo_from_score(score + margin);
+
+    printf("%+8.1f  [%+.1f, %+.1f]", elo, low, high);
+}
+
+
+//Print per-engine and per-pairing results
+
+static void print_report(Tournament *t, double seconds) {
+    int played = atomic_load(&t->played);
+
+    printf("\n=== TOURNAMENT RESULTS ===\n");
+    printf("Games: %d in %.2f s (%.1f games/sec, %d threads)\n",
+           played, seconds, played / seconds, t->threads);
+    printf("Seed: %llu\n\n", (unsigned long long)t->seed);
+
+    int two_player = 0, multi_player = 0;
+    for (int e = 0; e < t->num_engines; e++) {
+        for (int o = 0; o < t->num_engines; o++) {
+            two_player += t->records[e][o].wins + t->records[e][o].draws + t->records[e][o].losses;
+        }
+        multi_player += t->multi[e].wins + t->multi[e].draws + t->multi[e].losses;
+    }
+
+    if (two_player) {
+        printf("2-player games\n");
+        printf("%-10s %6s %6s %6s %6s   %s\n", "Engine", "Games", "Wins", "Draws", "Losses", "Elo vs field (95% CI)");
+        for (int e = 0; e < t->num_engines; e++) {
+            Record total = {0, 0, 0};
+            for (int o = 0; o < t->num_engines; o++) {
+                total.wins += t->records[e][o].wins;
+                total.draws += t->records[e][o].draws;
+                total.losses += t->records[e][o].losses;
+            }
+            printf("%-10s %6d %6d %6d %6d   ", t->engines[e].name,
+                   total.wins + total.draws + total.losses, total.wins, total.draws, total.losses);
+            print_elo(&total);
+            printf("\n");
+        }
+
+        printf("\n%-10s %-10s %6s %6s %6s   %s\n", "Engine", "Opponent", "Wins", "Draws", "Losses", "Elo (95% CI)");
+        for (int a = 0; a < t->num_engines; a++) {
+            for (int b = a + 1; b < t->num_engines; b++) {
+                const Record *r = &t->records[a][b];
+                if (r->wins + r->draws + r->losses == 0) continue;
+                printf("%-10s %-10s %6d %6d %6d   ", t->engines[a].name, t->engines[b].name,
+                       r->wins, r->draws, r->losses);
+                print_elo(r);
+                printf("\n");
+            }
+        }
+    }
+
+    // A 3-player game has no pairwise Elo, so only the outcomes are shown
+    if (multi_player) {
+        printf("%s3-player games (losses are games another engine won)\n", two_player ? "\n" : "");
+        printf("%-10s %6s %6s %6s %6s   %s\n", "Engine", "Games", "Wins", "Draws", "Losses", "Win %");
+        for (int e = 0; e < t->num_engines; e++) {
+            const Record *r = &t->multi[e];
+            int n = r->wins + r->draws + r->losses;
+            if (n == 0) continue;
+            printf("%-10s %6d %6d %6d %6d   %5.1f\n", t->engines[e].name, n, r->wins, r->draws, r->losses,
+                   100.0 * r->wins / n);
+        }
+    }
+}
+
+
+//Read the command line into the tournament settings
+
+static int parse_args(Tournament *t, int argc, char **argv) {
+    char engines[256] = "random,d1,d2,d4";
+
+    t->sizes[0] = 3;
+    t->num_sizes = 1;
+    t->player_counts[0] = 2;
+    t->num_counts = 1;
+    t->games = 10;
+    t->rotate = 1;
+    t->openings = 2;
+    t->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    t->seed = rng_time_seed();
+    t->hash_mb = 4;
+    t->solve_empty = SOLVER_EMPTY_CELLS;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--no-rotate") == 0) {
+            t->rotate = 0;
+            continue;
+        }
+        if (!value) {
+            printf("Missing value for %s\n", arg);
+            return 0;
+        }
+        i++;
+
+        if (strcmp(arg, "--engines") == 0) {
+            snprintf(engines, sizeof(engines), "%s", value);
+        } else if (strcmp(arg, "--mode") == 0) {
+            t->gauntlet = strcmp(value, "gauntlet") == 0;
+            if (!t->gauntlet && strcmp(value, "rr") != 0) {
+                printf("Unknown mode '%s' (use rr or gauntlet)\n", value);
+                return 0;
+            }
+        } else if (strcmp(arg, "--sizes") == 0) {
+            if ((t->num_sizes = parse_list(value, t->sizes, MAX_SIZES, MIN_SIZE, MAX_SIZE)) <= 0) return 0;
+        } else if (strcmp(arg, "--players") == 0) {
+            if ((t->num_counts = parse_list(value, t->player_counts, 2, 2, MAX_PLAYERS)) <= 0) return 0;
+        } else if (strcmp(arg, "--games") == 0) {
+            t->games = atoi(value);
+        } else if (strcmp(arg, "--openings") == 0) {
+            t->openings = atoi(value);
+        } else if (strcmp(arg, "--threads") == 0) {
+            t->threads = atoi(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            t->seed = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "--hash") == 0) {
+            t->hash_mb = (size_t)atoi(value);
+        } else if (strcmp(arg, "--solve") == 0) {
+            t->solve_empty = atoi(value);
+        } else if (strcmp(arg, "--sprt") == 0) {
+            if (sscanf(value, "%lf,%lf", &t->elo0, &t->elo1) != 2 || t->elo0 >= t->elo1) {
+                printf("Invalid SPRT bounds '%s' (use E0,E1 with E0 < E1)\n", value);
+                return 0;
+            }
+            t->sprt = 1;
+        } else {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+    }
+
+    for (char *item = strtok(engines, ","); item; item = strtok(NULL, ",")) {
+        if (t->num_engines == MAX_ENGINES || !parse_engine(item, &t->engines[t->num_engines])) {
+            return 0;
+        }
+        t->num_engines++;
+    }
+
+    if (t->games < 1 || t->threads < 1 || t->openings < 0) {
+        printf("Games and threads must be positive\n");
+        return 0;
+    }
+    for (int c = 0; c < t->num_counts; c++) {
+        if (t->num_engines < t->player_counts[c]) {
+            printf("Need at least %d engines for %d-player games\n", t->player_counts[c], t->player_counts[c]);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+int main(int argc, char **argv) {
+    static Tournament t;
+    struct timespec started;
+
+    if (!parse_args(&t, argc, argv) || !build_jobs(&t)) {
+        return 1;
+    }
+    pthread_mutex_init(&t.lock, NULL);
+
+    printf("=== TOURNAMENT: %d engines, %d games scheduled, %d threads ===\n",
+           t.num_engines, t.num_jobs, t.threads);
+
+    pthread_t *threads = (pthread_t*)malloc(t.threads * sizeof(pthread_t));
+    if (!threads) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    int started_threads = 0;
+    for (; started_threads < t.threads; started_threads++) {
+        if (pthread_create(&threads[started_threads], NULL, worker_thread, &t) != 0) {
+            // Empty the queue so the workers already running stop after their current game
+            printf("Could not start worker thread %d\n", started_threads + 1);
+            atomic_store(&t.next_job, t.num_jobs);
+            break;
+        }
+    }
+    for (int i = 0; i < started_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int ok = started_threads == t.threads && !atomic_load(&t.failed);
+    if (ok) {
+        print_report(&t, elapsed_ms_since(&started) / 1000.0);
+    } else {
+        printf("Tournament aborted after %d games, no report\n", atomic_load(&t.played));
+    }
+
+    free(threads);
+    free(t.jobs);
+    pthread_mutex_destroy(&t.lock);
+    return ok ? 0 : 1;
+}
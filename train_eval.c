@@ -0,0 +1,290 @@
+// Offline trainer for the learned evaluation used by the search engine
+//
+// Plays self-play games with the engine, then fits the per-line weights of
+// eval.c to the game results with logistic regression and writes a weights file.
+//
+// Build: gcc -O2 -pthread train_eval.c engine.c order.c eval.c solver.c tt.c rng.c stats.c -o train_eval -lm
+// Usage: train_eval --size N --players P [options]
+//   --games G      self-play games (default 2000)
+//   --depth D      search depth of the self-play engine (default 2)
+//   --openings K   random plies at the start of every game (default 2)
+//   --noise N      percent of later moves played at random, so games are decisive (default 10)
+//   --epochs E     passes over the recorded positions (default 20)
+//   --rate R       learning rate in weight units (default 20)
+//   --seed S       master seed (default: from the clock)
+//   --init FILE    start from these weights instead of the built-in ones
+//   --out FILE     output file (default eval_NxN_Pp.bin)
+
+#include <math.h>
+#include "eval.h"
+
+// One recorded position and the result of its game
+typedef struct {
+    unsigned char cells[MAX_CELLS];
+    signed char winner;
+} Sample;
+
+// Trainer settings
+typedef struct {
+    int size;
+    int num_players;
+    int games;
+    int depth;
+    int openings;
+    int noise;
+    int epochs;
+    double rate;
+    uint64_t seed;
+    const char *init;
+    char out[64];
+} Options;
+
+
+//Play the self-play games and record every position after the openings
+
+static Sample* self_play(Engine *engine, const Options *opt, int *num_samples) {
+    int cells = opt->size * opt->size;
+    Sample *samples = (Sample*)malloc((size_t)opt->games * cells * sizeof(Sample));
+    if (!samples) {
+        printf("Memory allocation failed!\n");
+        return NULL;
+    }
+
+    *num_samples = 0;
+    for (int g = 0; g < opt->games; g++) {
+        Position pos;
+        Rng rng;
+        int first = *num_samples;
+        int winner = -1;
+
+        rng_seed(&rng, opt->seed, (uint64_t)g);
+        position_init(engine, &pos);
+
+        for (int ply = 0; pos.empty > 0 && winner < 0; ply++) {
+            int cell;
+
+            if (ply >= opt->openings) {
+                memcpy(samples[*num_samples].cells, pos.cells, MAX_CELLS);
+                (*num_samples)++;
+            }
+
+            if (ply < opt->openings || (int)rng_below(&rng, 100) < opt->noise) {
+                cell = position_random_move(&pos, &rng);
+            } else {
+                SearchResult result;
+                engine_search(engine, &pos, pos.to_move, -1, &result);
+                cell = result.move;
+            }
+
+            int mover = pos.to_move;
+            if (position_make(engine, &pos, cell)) {
+                winner = mover;
+            }
+        }
+
+        for (int i = first; i < *num_samples; i++) {
+            samples[i].winner = (signed char)winner;
+        }
+    }
+
+    return samples;
+}
+
+
+//Per-line piece counts of a recorded position
+
+static void count_lines(const Engine *engine, const Sample *sample, unsigned char counts[MAX_LINES][MAX_PLAYERS]) {
+    memset(counts, 0, MAX_LINES * MAX_PLAYERS);
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int k = 0; k < engine->size; k++) {
+            int cell = engine->line_cells[line][k];
+            if (sample->cells[cell]) {
+                counts[line][sample->cells[cell] - 1]++;
+            }
+        }
+    }
+}
+
+
+//One pass of stochastic gradient descent, returns the mean log loss
+
+static double train_epoch(const Engine *engine, const Options *opt, float w[MAX_LINES][MAX_PLAYERS][MAX_SIZE + 1],
+                          const Sample *samples, const int *order, int num_samples, int update) {
+    int np = opt->num_players;
+    double loss = 0;
+
+    for (int i = 0; i < num_samples; i++) {
+        const Sample *sample = &samples[order[i]];
+        unsigned char counts[MAX_LINES][MAX_PLAYERS];
+        int owner[MAX_LINES];
+
+        count_lines(engine, sample, counts);
+        for (int line = 0; line < engine->num_lines; line++) {
+            owner[line] = -1;
+            for (int p = 0; p < np; p++) {
+                if (counts[line][p]) {
+                    owner[line] = owner[line] == -1 ? p : -2;
+                }
+            }
+        }
+
+        for (int q = 0; q < np; q++) {
+            double x = 0;
+            for (int line = 0; line < engine->num_lines; line++) {
+                if (owner[line] >= 0) {
+                    x += w[line][(owner[line] - q + np) % np][counts[line][owner[line]]];
+                }
+            }
+
+            double target = sample->winner < 0 ? 1.0 / np : (sample->winner == q ? 1.0 : 0.0);
+            double pred = 1 / (1 + exp(-x / EVAL_SCALE));
+            if (pred < 1e-9) pred = 1e-9;
+            if (pred > 1 - 1e-9) pred = 1 - 1e-9;
+            loss -= target * log(pred) + (1 - target) * log(1 - pred);
+
+            if (update) {
+                float step = (float)(opt->rate * (pred - target));
+                for (int line = 0; line < engine->num_lines; line++) {
+                    if (owner[line] >= 0) {
+                        w[line][(owner[line] - q + np) % np][counts[line][owner[line]]] -= step;
+                    }
+                }
+            }
+        }
+    }
+
+    return loss / ((double)num_samples * np);
+}
+
+
+//Read the command line
+
+static int parse_args(Options *opt, int argc, char **argv) {
+    opt->games = 2000;
+    opt->depth = 2;
+    opt->openings = 2;
+    opt->noise = 10;
+    opt->epochs = 20;
+    opt->rate = 20;
+    opt->seed = rng_time_seed();
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i], *value = argv[i + 1];
+
+        if (strcmp(arg, "--size") == 0) opt->size = atoi(value);
+        else if (strcmp(arg, "--players") == 0) opt->num_players = atoi(value);
+        else if (strcmp(arg, "--games") == 0) opt->games = atoi(value);
+        else if (strcmp(arg, "--depth") == 0) opt->depth = atoi(value);
+        else if (strcmp(arg, "--openings") == 0) opt->openings = atoi(value);
+        else if (strcmp(arg, "--noise") == 0) opt->noise = atoi(value);
+        else if (strcmp(arg, "--epochs") == 0) opt->epochs = atoi(value);
+        else if (strcmp(arg, "--rate") == 0) opt->rate = atof(value);
+        else if (strcmp(arg, "--seed") == 0) opt->seed = strtoull(value, NULL, 10);
+        else if (strcmp(arg, "--init") == 0) opt->init = value;
+        else if (strcmp(arg, "--out") == 0) snprintf(opt->out, sizeof(opt->out), "%s", value);
+        else {
+            printf("Unknown option %s\n", arg);
+            return 0;
+        }
+    }
+
+    if (opt->size < MIN_SIZE || opt->size > MAX_SIZE || opt->num_players < 2 ||
+        opt->num_players > MAX_PLAYERS || opt->games < 1 || opt->depth < 1) {
+        printf("Usage: train_eval --size %d-%d --players 2-%d [--games G] [--depth D] [--openings K]\n"
+               "                  [--noise N] [--epochs E] [--rate R] [--seed S] [--init FILE] [--out FILE]\n",
+               MIN_SIZE, MAX_SIZE, MAX_PLAYERS);
+        return 0;
+    }
+    if (!opt->out[0]) {
+        eval_file_name(opt->out, sizeof(opt->out), opt->size, opt->num_players);
+    }
+
+    return 1;
+}
+
+
+int main(int argc, char **argv) {
+    static float w[MAX_LINES][MAX_PLAYERS][MAX_SIZE + 1];
+    Options opt = {0};
+    int num_samples;
+
+    if (!parse_args(&opt, argc, argv)) {
+        return 1;
+    }
+
+    Engine *engine = engine_create(opt.size, opt.num_players, ENGINE_TT_MB);
+    if (!engine) {
+        return 1;
+    }
+    engine->max_depth = opt.depth;
+    if (opt.init && !eval_load(engine, opt.init)) {
+        printf("Could not load '%s'\n", opt.init);
+        return 1;
+    }
+
+    printf("Self-play: %d games on %dx%d with %d players, depth %d, seed %llu\n",
+           opt.games, opt.size, opt.size, opt.num_players, opt.depth, (unsigned long long)opt.seed);
+    Sample *samples = self_play(engine, &opt, &num_samples);
+    if (!samples || num_samples == 0) {
+        printf("No positions recorded\n");
+        return 1;
+    }
+
+    int *order = (int*)malloc(num_samples * sizeof(int));
+    if (!order) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    for (int i = 0; i < num_samples; i++) {
+        order[i] = i;
+    }
+
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int rel = 0; rel < opt.num_players; rel++) {
+            for (int c = 0; c <= opt.size; c++) {
+                w[line][rel][c] = engine->weights[line][rel][c];
+            }
+        }
+    }
+
+    Rng rng;
+    rng_seed(&rng, opt.seed, (uint64_t)opt.games);
+    int wins[MAX_PLAYERS] = {0}, draws = 0;
+    for (int i = 0; i < num_samples; i++) {
+        if (samples[i].winner < 0) draws++;
+        else wins[(int)samples[i].winner]++;
+    }
+    printf("Positions: %d (from won games: %d/%d/%d, drawn: %d)\n", num_samples, wins[0], wins[1], wins[2], draws);
+    printf("Initial loss %.4f\n",
+           train_epoch(engine, &opt, w, samples, order, num_samples, 0));
+
+    for (int epoch = 1; epoch <= opt.epochs; epoch++) {
+        for (int i = num_samples - 1; i > 0; i--) {
+            int j = (int)rng_below(&rng, (uint32_t)(i + 1));
+            int t = order[i]; order[i] = order[j]; order[j] = t;
+        }
+        double loss = train_epoch(engine, &opt, w, samples, order, num_samples, 1);
+        printf("Epoch %d: loss %.4f\n", epoch, loss);
+    }
+
+    // Quantize to int16, count 0 always stays worth nothing
+    for (int line = 0; line < engine->num_lines; line++) {
+        for (int rel = 0; rel < opt.num_players; rel++) {
+            engine->weights[line][rel][0] = 0;
+            for (int c = 1; c <= opt.size; c++) {
+                float v = roundf(w[line][rel][c]);
+                engine->weights[line][rel][c] = (int16_t)(v > 32767 ? 32767 : (v < -32767 ? -32767 : v));
+            }
+        }
+    }
+
+    int ok = eval_save(engine, opt.out);
+    if (ok) {
+        printf("Weights written to '%s'\n", opt.out);
+    }
+
+    free(order);
+    free(samples);
+    engine_destroy(engine);
+    return ok ? 0 : 1;
+}
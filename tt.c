@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "tt.h"
+#include "stats.h"
+
+// Fields packed into a slot's data word
+#define DATA_DEPTH_SHIFT 32
+#define DATA_FLAG_SHIFT 40
+#define DATA_MOVE_SHIFT 48
+#define DATA_GENERATION_SHIFT 56
+#define DATA_USED 0x80
+
+// Part of the table cleared by one thread
+typedef struct {
+    char *start;
+    size_t bytes;
+} ClearJob;
+
+
+//Set up a table of roughly the requested size
+
+int tt_init(TransTable *tt, size_t megabytes) {
+    memset(tt, 0, sizeof(TransTable));
+    return tt_resize(tt, megabytes);
+}
+
+
+//Map a new zeroed table of roughly the requested size and drop the old one;
+//on failure the old table is kept
+
+int tt_resize(TransTable *tt, size_t megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(TTBucket) <= megabytes * 1024 * 1024) {
+        count *= 2;
+    }
+    size_t bytes = count * sizeof(TTBucket);
+
+    // Map an extra huge page so the table can start on a huge page boundary
+    int huge = TT_HUGE_PAGES && bytes >= TT_HUGE_PAGE_SIZE;
+    size_t map_bytes = bytes + (huge ? TT_HUGE_PAGE_SIZE : 0);
+    char *region = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        printf("Memory allocation failed!\n");
+        return 0;
+    }
+
+    if (huge) {
+        size_t head = (TT_HUGE_PAGE_SIZE - (uintptr_t)region % TT_HUGE_PAGE_SIZE) % TT_HUGE_PAGE_SIZE;
+        size_t tail = map_bytes - head - bytes;
+        if (head) munmap(region, head);
+        if (tail) munmap(region + head + bytes, tail);
+        region += head;
+        map_bytes = bytes;
+#ifdef MADV_HUGEPAGE
+        huge = madvise(region, bytes, MADV_HUGEPAGE) == 0;
+#else
+        huge = 0;
+#endif
+    }
+    STATS_INC(allocations);
+
+    tt_free(tt);
+    tt->region = region;
+    tt->region_bytes = map_bytes;
+    tt->buckets = (TTBucket*)region;
+    tt->mask = count - 1;
+    tt->huge_pages = huge;
+    return 1;
+}
+
+
+//Release the table memory
+
+void tt_free(TransTable *tt) {
+    if (tt->region) {
+        munmap(tt->region, tt->region_bytes);
+    }
+    tt->region = NULL;
+    tt->region_bytes = 0;
+    tt->buckets = NULL;
+    tt->mask = 0;
+    tt->huge_pages = 0;
+    tt->generation = 0;
+}
+
+
+static void* clear_thread(void *arg) {
+    ClearJob *job = (ClearJob*)arg;
+    memset(job->start, 0, job->bytes);
+    return NULL;
+}
+
+
+//Forget every stored position, large tables are cleared by several threads
+
+void tt_clear(TransTable *tt) {
+    if (!tt->buckets) {
+        return;
+    }
+
+    size_t bytes = (tt->mask + 1) * sizeof(TTBucket);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = bytes / TT_CLEAR_CHUNK;
+    if (threads > TT_CLEAR_THREADS) threads = TT_CLEAR_THREADS;
+    if (cores > 0 && threads > (size_t)cores) threads = (size_t)cores;
+    if (threads < 1) threads = 1;
+
+    pthread_t ids[TT_CLEAR_THREADS];
+    ClearJob jobs[TT_CLEAR_THREADS];
+    int started[TT_CLEAR_THREADS] = {0};
+    size_t share = bytes / threads;
+
+    for (size_t t = 0; t < threads; t++) {
+        jobs[t].start = (char*)tt->buckets + t * share;
+        jobs[t].bytes = t + 1 == threads ? bytes - t * share : share;
+    }
+
+    // The calling thread takes the first part, and any part whose thread did not start
+    for (size_t t = 1; t < threads; t++) {
+        started[t] = pthread_create(&ids[t], NULL, clear_thread, &jobs[t]) == 0;
+    }
+    for (size_t t = 0; t < threads; t++) {
+        if (!started[t]) clear_thread(&jobs[t]);
+    }
+    for (size_t t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(ids[t], NULL);
+    }
+
+    tt->generation = 0;
+}
+
+
+//Start a new search: entries from earlier searches become the first to be replaced
+
+void tt_new_search(TransTable *tt) {
+    tt->generation++;
+}
+
+
+//Look up a position, returns 0 when it is not stored
+
+int tt_probe(TransTable *tt, uint64_t key, TTEntry *entry) {
+    TTBucket *bucket = &tt->buckets[key & tt->mask];
+    STATS_INC(tt_probes);
+
+    for (int i = 0; i < TT_BUCKET_SLOTS; i++) {
+        uint64_t data = bucket->slots[i].data;
+        if ((bucket->slots[i].key ^ data) != key || !data) {
+            continue;
+        }
+
+        entry->key = key;
+        entry->score = (int32_t)(uint32_t)data;
+        entry->depth = (int8_t)(data >> DATA_DEPTH_SHIFT);
+        entry->flag = (uint8_t)(data >> DATA_FLAG_SHIFT) & ~DATA_USED;
+        entry->move = (int8_t)(data >> DATA_MOVE_SHIFT);
+        STATS_INC(tt_hits);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+//Store a search result, deeper results for the same position are kept;
+//otherwise an empty slot is used, or the shallowest and oldest one
+
+void tt_store(TransTable *tt, uint64_t key, int score, int depth, int flag, int move) {
+    TTBucket *bucket = &tt->buckets[key & tt->mask];
+    TTSlot *victim = NULL;
+    int victim_worth = 0;
+
+    for (int i = 0; i < TT_BUCKET_SLOTS; i++) {
+        TTSlot *slot = &bucket->slots[i];
+        uint64_t data = slot->data;
+
+        if (!data) {
+            if (!victim || victim_worth > INT_MIN) {
+                victim = slot;
+                victim_worth = INT_MIN;
+            }
+            continue;
+        }
+        if ((slot->key ^ data) == key) {
+            if ((int8_t)(data >> DATA_DEPTH_SHIFT) > depth) {
+                return;
+            }
+            victim = slot;
+            break;
+        }
+
+        uint8_t age = (uint8_t)(tt->generation - (uint8_t)(data >> DATA_GENERATION_SHIFT));
+        int worth = (int8_t)(data >> DATA_DEPTH_SHIFT) - 4 * age;
+        if (!victim || worth < victim_worth) {
+            victim = slot;
+            victim_worth = worth;
+        }
+    }
+
+    uint64_t data = (uint64_t)(uint32_t)score
+                  | (uint64_t)(uint8_t)depth << DATA_DEPTH_SHIFT
+                  | (uint64_t)(flag | DATA_USED) << DATA_FLAG_SHIFT
+                  | (uint64_t)(uint8_t)move << DATA_MOVE_SHIFT
+                  | (uint64_t)tt->generation << DATA_GENERATION_SHIFT;
+    victim->data = data;
+    victim->key = key ^ data;
+}
@@ -0,0 +1,75 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Bound types stored with each entry
+#define TT_EXACT 0
+#define TT_LOWER 1
+#define TT_UPPER 2
+
+// Table layout: buckets of slots filling one cache line
+#define TT_CACHE_LINE 64
+#define TT_BUCKET_SLOTS 4
+
+// Large tables are aligned to and advised as transparent huge pages
+// (build with -DTT_HUGE_PAGES=0 to leave them as normal pages)
+#ifndef TT_HUGE_PAGES
+#define TT_HUGE_PAGES 1
+#endif
+#define TT_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Clearing splits the table between threads, one per this many bytes
+#define TT_CLEAR_THREADS 8
+#define TT_CLEAR_CHUNK (32 * 1024 * 1024)
+
+// Transposition table entry, as returned by tt_probe
+typedef struct {
+    uint64_t key;
+    int32_t score;
+    int8_t depth;
+    uint8_t flag;
+    int8_t move;
+} TTEntry;
+
+// Stored entry: data packs score, depth, flag, move and generation, and key
+// holds key ^ data, so a slot torn by two threads writing at once never verifies
+typedef struct {
+    uint64_t key;
+    uint64_t data;
+} TTSlot;
+
+// One cache line of slots
+typedef struct {
+    _Alignas(TT_CACHE_LINE) TTSlot slots[TT_BUCKET_SLOTS];
+} TTBucket;
+
+// Transposition table (power-of-two number of buckets in one mapped region)
+typedef struct {
+    TTBucket *buckets;
+    size_t mask;
+    void *region;
+    size_t region_bytes;
+    int huge_pages;
+    uint8_t generation;
+} TransTable;
+
+// Function prototypes
+int tt_init(TransTable *tt, size_t megabytes);
+int tt_resize(TransTable *tt, size_t megabytes);
+void tt_free(TransTable *tt);
+void tt_clear(TransTable *tt);
+void tt_new_search(TransTable *tt);
+int tt_probe(TransTable *tt, uint64_t key, TTEntry *entry);
+void tt_store(TransTable *tt, uint64_t key, int score, int depth, int flag, int move);
+
+
+//Start loading the bucket of a position, so it is in cache when the search probes it
+
+static inline void tt_prefetch(const TransTable *tt, uint64_t key) {
+    __builtin_prefetch(&tt->buckets[key & tt->mask]);
+}
+
+
+#endif